@@ -0,0 +1,639 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "benchmark.h"
+#include "mathUtil.h"
+#include "csvHandler.h"
+#include "vecvol.h"
+#include "spatialIndex.h"
+#include "convexHull.h"
+#include "gramMatrix.h"
+#include "streamStats.h"
+#include "vectorExpr.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define KERNEL_COUNT (1 << 18)
+#define SHAPE_COUNT 4096
+#define POINT_COUNT (1 << 16)
+#define HULL_POINT_COUNT (1 << 18)
+#define GRAM_COUNT 2048      // Full matrix: 32 MB of output
+#define GRAM_TOP_COUNT 8192  // Top-k search: 33.5M pairs
+#define GRAM_TOP_K 10
+#define SYNTHETIC_ROWS 100000
+#define MAX_NOISE_ALLOWANCE 0.25 // Largest drop excused as noise, however noisy the runs
+#define MAX_BENCHMARKS 64
+#define MAX_RUNS 100
+#define NAME_LENGTH 64
+
+// --- Data Structures ---
+
+// Inputs shared by every benchmark, built once before timing starts
+typedef struct {
+    size_t count;
+    vector *v1, *v2, *v3;
+    double *a, *b, *c, *out;
+    double *cross_out;
+    long long *int_coords;
+    Parallelepiped *shapes;
+    PackedVector *points;
+    SpatialIndex *bvh;
+    PackedVector *hull_points;
+    double *gram_out;
+    ValueStats *stats;
+    VectorExpr *expr;      // (V1 x V2) . V3
+    const char *csv_path;
+    VvContext *ctx;
+} BenchData;
+
+// Runs one repetition and returns the number of items it processed (<0 on error)
+typedef double (*BenchFunction)(BenchData *data);
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    BenchFunction run;
+} BenchCase;
+
+typedef struct {
+    char name[NAME_LENGTH];
+    double median;       // Items per second
+    double relative_mad; // Median absolute deviation / median
+} BenchResult;
+
+// Keeps the optimizer from discarding benchmark results
+static volatile double bench_sink;
+
+// --- Helper Prototypes ---
+static double now_seconds(void);
+static double median_of(double *values, int count);
+static bool prepare_data(BenchData *data, const char *csv_path);
+static void free_data(BenchData *data);
+static FILE *create_temp_file(char *path, size_t path_size);
+static bool write_synthetic_csv(char *path, size_t path_size, size_t rows);
+static int load_baseline(const char *path, BenchResult *results, int max_results);
+static bool save_baseline(const char *path, const BenchResult *results, int count);
+static const BenchResult *find_result(const BenchResult *results, int count, const char *name);
+static bool is_bench_case(const char *name);
+
+static double now_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static int compare_doubles(const void *lhs, const void *rhs) {
+    double a = *(const double*)lhs, b = *(const double*)rhs;
+    return (a > b) - (a < b);
+}
+
+// Sorts values in place and returns their median
+static double median_of(double *values, int count) {
+    qsort(values, (size_t)count, sizeof(double), compare_doubles);
+    if (count % 2 == 1) return values[count / 2];
+    return 0.5 * (values[count / 2 - 1] + values[count / 2]);
+}
+
+// --- Benchmark Bodies ---
+
+static double bench_scalar_product(BenchData *data) {
+    double sum = 0.0;
+    for (size_t i = 0; i < data->count; i++) sum += scalaricProduct(data->v1[i], data->v2[i]);
+    bench_sink = sum;
+    return (double)data->count;
+}
+
+static double bench_cross_product(BenchData *data) {
+    double sum = 0.0;
+    for (size_t i = 0; i < data->count; i++) sum += crossProduct(data->v1[i], data->v2[i]).magnitude;
+    bench_sink = sum;
+    return (double)data->count;
+}
+
+static double bench_volume(BenchData *data) {
+    double sum = 0.0;
+    for (size_t i = 0; i < data->count; i++) {
+        vector vectors[3] = {data->v1[i], data->v2[i], data->v3[i]};
+        sum += volumeParallelepiped(vectors, 1.0);
+    }
+    bench_sink = sum;
+    return (double)data->count;
+}
+
+static double bench_volume_exact(BenchData *data) {
+    double sum = 0.0;
+    for (size_t i = 0; i < data->count; i++) sum += volumeParallelepipedExact(&data->int_coords[9 * i], 1.0);
+    bench_sink = sum;
+    return (double)data->count;
+}
+
+static double bench_volume_packed(BenchData *data) {
+    // a, b, c are interleaved x,y,z arrays: the same layout as PackedVector[]
+    const PackedVector *p1 = (const PackedVector*)data->a;
+    const PackedVector *p2 = (const PackedVector*)data->b;
+    const PackedVector *p3 = (const PackedVector*)data->c;
+    double sum = 0.0;
+
+    for (size_t i = 0; i < data->count; i++) {
+        PackedVector vectors[3] = {p1[i], p2[i], p3[i]};
+        sum += volumeParallelepipedPacked(vectors, 1.0);
+    }
+    bench_sink = sum;
+    return (double)data->count;
+}
+
+static double bench_batch_volume(BenchData *data) {
+    if (vv_batch_volume(data->ctx, data->a, data->b, data->c, data->count, 1.0, data->out) != VV_OK) return -1.0;
+    bench_sink = data->out[data->count - 1];
+    return (double)data->count;
+}
+
+static double bench_expr_triple_product(BenchData *data) {
+    const PackedVector *const vectors[3] = {
+        (const PackedVector*)data->a, (const PackedVector*)data->b, (const PackedVector*)data->c
+    };
+    if (!expr_evaluate(data->expr, vectors, data->count, data->out)) return -1.0;
+    bench_sink = data->out[data->count - 1];
+    return (double)data->count;
+}
+
+static double bench_batch_cross(BenchData *data) {
+    if (vv_batch_cross_product(data->ctx, data->a, data->b, data->count, data->cross_out, data->out) != VV_OK) return -1.0;
+    bench_sink = data->out[data->count - 1];
+    return (double)data->count;
+}
+
+static double bench_bvh_containment(BenchData *data) {
+    ContainmentResult result;
+    if (!spatial_index_query(data->bvh, data->points, POINT_COUNT, &result)) return -1.0;
+    bench_sink = (double)result.row_offsets[POINT_COUNT];
+    free_containment_result(&result);
+    return (double)POINT_COUNT;
+}
+
+static double bench_convex_hull(BenchData *data) {
+    ConvexHull hull;
+    if (!convex_hull_build(data->hull_points, HULL_POINT_COUNT, &hull)) return -1.0;
+    bench_sink = hull.volume;
+    free_convex_hull(&hull);
+    return (double)HULL_POINT_COUNT;
+}
+
+static double bench_batch_transform(BenchData *data) {
+    static const double matrix[9] = { 0.8, -0.6, 0.0, 0.6, 0.8, 0.0, 0.1, 0.2, 2.0 };
+    double determinant;
+    if (vv_batch_affine_transform(data->ctx, matrix, NULL, data->a, data->count, data->cross_out, &determinant) != VV_OK) return -1.0;
+    bench_sink = data->cross_out[3 * data->count - 1] + determinant;
+    return (double)data->count;
+}
+
+static double bench_gram_matrix(BenchData *data) {
+    if (!gram_matrix(data->hull_points, GRAM_COUNT, GRAM_COSINE, data->gram_out)) return -1.0;
+    bench_sink = data->gram_out[(size_t)GRAM_COUNT * GRAM_COUNT - 1];
+    return (double)GRAM_COUNT * GRAM_COUNT;
+}
+
+static double bench_gram_top_k(BenchData *data) {
+    AlignedPair pairs[GRAM_TOP_K];
+    size_t found;
+    if (!gram_top_aligned(data->hull_points, GRAM_TOP_COUNT, GRAM_TOP_K, false, pairs, &found) || found == 0) return -1.0;
+    bench_sink = pairs[found - 1].cosine;
+    return (double)GRAM_TOP_COUNT * (GRAM_TOP_COUNT - 1) / 2.0;
+}
+
+static double bench_stream_stats(BenchData *data) {
+    stats_init(data->stats, SKETCH_DEFAULT_ACCURACY);
+    stats_add_values(data->stats, data->a, 3 * data->count);
+    bench_sink = stats_quantile(data->stats, 0.99);
+    return (double)(3 * data->count);
+}
+
+static double bench_csv_parse(BenchData *data) {
+    CsvFile *csv = csv_open_quiet(data->csv_path);
+    TestCase test_case;
+    double rows = 0.0, sum = 0.0;
+
+    if (csv == NULL) return -1.0;
+    csv_read_line(csv); // Header
+    while (csv_read_line(csv)) {
+        if (csv_read_test_case(csv, &test_case)) sum += test_case.expected_volume;
+        rows++;
+    }
+    csv_close(csv);
+
+    bench_sink = sum;
+    return rows;
+}
+
+static double bench_csv_load_packed(BenchData *data) {
+    PackedTestSet set = csv_load_packed_test_set(data->csv_path);
+    double rows = (double)set.count;
+
+    if (set.count == 0) return -1.0;
+    bench_sink = set.expected_volume[set.count - 1];
+    free_packed_test_set(&set);
+    return rows;
+}
+
+static double bench_runner_volume(BenchData *data) {
+    VvTestSummary summary;
+    if (vv_run_volume_tests(data->ctx, data->csv_path, 1.0, &summary) != VV_OK) return -1.0;
+    return (double)summary.total;
+}
+
+static double bench_runner_cross(BenchData *data) {
+    VvTestSummary summary;
+    if (vv_run_cross_product_tests(data->ctx, data->csv_path, &summary) != VV_OK) return -1.0;
+    return (double)summary.total;
+}
+
+static double bench_runner_scalar(BenchData *data) {
+    VvTestSummary summary;
+    if (vv_run_scalar_product_tests(data->ctx, data->csv_path, &summary) != VV_OK) return -1.0;
+    return (double)summary.total;
+}
+
+static const BenchCase bench_cases[] = {
+    { "kernel_scalar_product", "ops/s",  bench_scalar_product },
+    { "kernel_cross_product",  "ops/s",  bench_cross_product },
+    { "kernel_volume",         "ops/s",  bench_volume },
+    { "kernel_volume_exact",   "ops/s",  bench_volume_exact },
+    { "kernel_volume_packed",  "ops/s",  bench_volume_packed },
+    { "batch_volume",          "ops/s",  bench_batch_volume },
+    { "batch_cross_product",   "ops/s",  bench_batch_cross },
+    { "expr_triple_product",   "ops/s",  bench_expr_triple_product },
+    { "batch_transform",       "vec/s",  bench_batch_transform },
+    { "bvh_containment",       "pts/s",  bench_bvh_containment },
+    { "convex_hull",           "pts/s",  bench_convex_hull },
+    { "gram_matrix",           "prs/s",  bench_gram_matrix },
+    { "gram_top_k",            "prs/s",  bench_gram_top_k },
+    { "stream_stats",          "val/s",  bench_stream_stats },
+    { "csv_parse",             "rows/s", bench_csv_parse },
+    { "csv_load_packed",       "rows/s", bench_csv_load_packed },
+    { "runner_volume",         "rows/s", bench_runner_volume },
+    { "runner_cross_product",  "rows/s", bench_runner_cross },
+    { "runner_scalar_product", "rows/s", bench_runner_scalar },
+};
+
+// --- Input Preparation ---
+
+// Deterministic pseudo-random integers in [-range, range]
+static long long next_random(unsigned long long *state, long long range) {
+    *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+    return (long long)((*state >> 33) % (unsigned long long)(2 * range + 1)) - range;
+}
+
+static bool prepare_data(BenchData *data, const char *csv_path) {
+    size_t n = KERNEL_COUNT;
+    unsigned long long state = 42;
+    char error[256];
+
+    memset(data, 0, sizeof(*data));
+    data->count = n;
+    data->csv_path = csv_path;
+    data->v1 = (vector*)malloc(n * sizeof(vector));
+    data->v2 = (vector*)malloc(n * sizeof(vector));
+    data->v3 = (vector*)malloc(n * sizeof(vector));
+    data->a = (double*)malloc(3 * n * sizeof(double));
+    data->b = (double*)malloc(3 * n * sizeof(double));
+    data->c = (double*)malloc(3 * n * sizeof(double));
+    data->out = (double*)malloc(n * sizeof(double));
+    data->cross_out = (double*)malloc(3 * n * sizeof(double));
+    data->int_coords = (long long*)malloc(9 * n * sizeof(long long));
+    data->shapes = (Parallelepiped*)malloc(SHAPE_COUNT * sizeof(Parallelepiped));
+    data->points = (PackedVector*)malloc(POINT_COUNT * sizeof(PackedVector));
+    data->hull_points = (PackedVector*)malloc(HULL_POINT_COUNT * sizeof(PackedVector));
+    data->gram_out = (double*)malloc((size_t)GRAM_COUNT * GRAM_COUNT * sizeof(double));
+    data->stats = (ValueStats*)malloc(sizeof(ValueStats));
+    data->expr = (VectorExpr*)malloc(sizeof(VectorExpr));
+
+    if (!data->v1 || !data->v2 || !data->v3 || !data->a || !data->b || !data->c ||
+        !data->out || !data->cross_out || !data->int_coords || !data->shapes || !data->points || !data->hull_points ||
+        !data->gram_out || !data->stats || !data->expr ||
+        !expr_compile("(V1 x V2) . V3", data->expr, error, sizeof(error)) ||
+        vv_context_create(&data->ctx) != VV_OK) {
+        free_data(data);
+        return false;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        vector *targets[3] = { &data->v1[i], &data->v2[i], &data->v3[i] };
+        double *flat[3] = { &data->a[3 * i], &data->b[3 * i], &data->c[3 * i] };
+
+        for (int v = 0; v < 3; v++) {
+            for (int j = 0; j < 3; j++) {
+                long long value = next_random(&state, 1000);
+                data->int_coords[9 * i + 3 * v + j] = value;
+                targets[v]->direction[j] = (double)value;
+                flat[v][j] = (double)value;
+            }
+            targets[v]->magnitude = 0.0;
+        }
+    }
+
+    // Small shapes scattered through a 1000^3 cube, queried with uniform points
+    for (size_t i = 0; i < SHAPE_COUNT; i++) {
+        data->shapes[i].origin = (PackedVector){ { (double)next_random(&state, 500) + 500.0,
+                                                   (double)next_random(&state, 500) + 500.0,
+                                                   (double)next_random(&state, 500) + 500.0 } };
+        for (int e = 0; e < 3; e++) {
+            data->shapes[i].edges[e] = (PackedVector){ { (double)next_random(&state, 40),
+                                                         (double)next_random(&state, 40),
+                                                         (double)next_random(&state, 40) } };
+        }
+    }
+    for (size_t i = 0; i < POINT_COUNT; i++) {
+        data->points[i] = (PackedVector){ { (double)next_random(&state, 500) + 500.0,
+                                            (double)next_random(&state, 500) + 500.0,
+                                            (double)next_random(&state, 500) + 500.0 } };
+    }
+    // Uniform points in a ball: a hull with thousands of faces
+    for (size_t i = 0; i < HULL_POINT_COUNT; i++) {
+        long long x, y, z;
+        do {
+            x = next_random(&state, 1000);
+            y = next_random(&state, 1000);
+            z = next_random(&state, 1000);
+        } while (x * x + y * y + z * z > 1000 * 1000);
+        data->hull_points[i] = (PackedVector){ { (double)x, (double)y, (double)z } };
+    }
+    data->bvh = spatial_index_build(data->shapes, SHAPE_COUNT, 0.001);
+    if (data->bvh == NULL) {
+        free_data(data);
+        return false;
+    }
+    return true;
+}
+
+static void free_data(BenchData *data) {
+    free(data->v1);
+    free(data->v2);
+    free(data->v3);
+    free(data->a);
+    free(data->b);
+    free(data->c);
+    free(data->out);
+    free(data->cross_out);
+    free(data->int_coords);
+    free(data->shapes);
+    free(data->points);
+    free(data->hull_points);
+    free(data->gram_out);
+    free(data->stats);
+    free(data->expr);
+    spatial_index_free(data->bvh);
+    vv_context_destroy(data->ctx);
+    memset(data, 0, sizeof(*data));
+}
+
+// Creates a new, uniquely named file in the temporary directory ($TMPDIR, or
+// the system default), so no file of the user's is ever overwritten
+static FILE *create_temp_file(char *path, size_t path_size) {
+#ifdef _WIN32
+    char directory[MAX_PATH];
+    DWORD length = GetTempPathA(sizeof(directory), directory);
+
+    if (length == 0 || length >= sizeof(directory) || path_size < MAX_PATH ||
+        GetTempFileNameA(directory, "vvb", 0, path) == 0) {
+        return NULL;
+    }
+    return fopen(path, "w");
+#else
+    const char *directory = getenv("TMPDIR");
+    int fd;
+
+    if (directory == NULL || directory[0] == '\0') directory = "/tmp";
+    if (snprintf(path, path_size, "%s/vecvol_bench_XXXXXX", directory) >= (int)path_size) return NULL;
+    fd = mkstemp(path);
+    if (fd < 0) return NULL;
+
+    FILE *file = fdopen(fd, "w");
+    if (file == NULL) {
+        close(fd);
+        remove(path);
+    }
+    return file;
+#endif
+}
+
+// Half integer rows, half fractional rows, so both volume paths are measured.
+// The file is created by create_temp_file; path receives its name.
+static bool write_synthetic_csv(char *path, size_t path_size, size_t rows) {
+    FILE *file = create_temp_file(path, path_size);
+    unsigned long long state = 7;
+
+    if (file == NULL) return false;
+
+    fprintf(file, "V1_X,V1_Y,V1_Z,V1_MAG,V2_X,V2_Y,V2_Z,V2_MAG,V3_X,V3_Y,V3_Z,V3_MAG,EXPECTED_VOLUME\n");
+    for (size_t r = 0; r < rows; r++) {
+        double v[3][3];
+        double scale = (r % 2 == 0) ? 1.0 : 0.25;
+
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) v[i][j] = (double)next_random(&state, 100) * scale;
+        }
+
+        vector vectors[3];
+        for (int i = 0; i < 3; i++) {
+            memcpy(vectors[i].direction, v[i], sizeof(v[i]));
+            vectors[i].magnitude = sqrt(v[i][0] * v[i][0] + v[i][1] * v[i][1] + v[i][2] * v[i][2]);
+            fprintf(file, "%g,%g,%g,%.3f,", v[i][0], v[i][1], v[i][2], vectors[i].magnitude);
+        }
+        fprintf(file, "%.3f\n", volumeParallelepiped(vectors, 1.0));
+    }
+
+    if (fclose(file) != 0) {
+        remove(path);
+        return false;
+    }
+    return true;
+}
+
+// --- Baseline Files ---
+
+// Format: one "name median relative_mad unit" line per benchmark, '#' comments
+static int load_baseline(const char *path, BenchResult *results, int max_results) {
+    FILE *file = fopen(path, "r");
+    char line[256];
+    int count = 0;
+
+    if (file == NULL) return -1;
+
+    while (count < max_results && fgets(line, sizeof(line), file) != NULL) {
+        BenchResult *result = &results[count];
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "%63s %lf %lf", result->name, &result->median, &result->relative_mad) == 3) {
+            count++;
+        }
+    }
+
+    fclose(file);
+    return count;
+}
+
+static bool save_baseline(const char *path, const BenchResult *results, int count) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "# vecvol benchmark baseline (calculator --bench --save-baseline)\n");
+    fprintf(file, "# name median_throughput relative_mad unit\n");
+    for (int i = 0; i < count; i++) {
+        const char *unit = "items/s";
+        for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+            if (strcmp(bench_cases[c].name, results[i].name) == 0) unit = bench_cases[c].unit;
+        }
+        fprintf(file, "%s %.6e %.6f %s\n", results[i].name, results[i].median, results[i].relative_mad, unit);
+    }
+
+    return fclose(file) == 0;
+}
+
+static const BenchResult *find_result(const BenchResult *results, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(results[i].name, name) == 0) return &results[i];
+    }
+    return NULL;
+}
+
+static bool is_bench_case(const char *name) {
+    for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+        if (strcmp(bench_cases[c].name, name) == 0) return true;
+    }
+    return false;
+}
+
+// --- Entry Point ---
+
+int run_benchmarks(const BenchmarkOptions *options) {
+    BenchResult results[MAX_BENCHMARKS];
+    BenchResult baseline[MAX_BENCHMARKS];
+    double samples[MAX_RUNS], deviations[MAX_RUNS];
+    char synthetic_path[1024];
+    BenchData data;
+    int result_count = 0, baseline_count = 0, regressions = 0;
+    int runs = options->runs > 0 ? options->runs : 7;
+    const char *csv_path = options->csv_path;
+
+    if (runs > MAX_RUNS) runs = MAX_RUNS;
+
+    if (options->baseline_path != NULL) {
+        baseline_count = load_baseline(options->baseline_path, baseline, MAX_BENCHMARKS);
+        if (baseline_count < 0) {
+            fprintf(stderr, "Error: Could not read baseline '%s'\n", options->baseline_path);
+            return 1;
+        }
+    }
+
+    if (csv_path == NULL) {
+        if (!write_synthetic_csv(synthetic_path, sizeof(synthetic_path), SYNTHETIC_ROWS)) {
+            perror("Error: Could not write the synthetic input file");
+            return 1;
+        }
+        csv_path = synthetic_path;
+    }
+
+    if (!prepare_data(&data, csv_path)) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        if (options->csv_path == NULL) remove(csv_path);
+        return 1;
+    }
+
+    printf("\n=== Benchmarks (%d runs each, threshold %.1f%%) ===\n", runs, options->threshold_pct);
+    printf("%-24s %19s %8s %11s %9s  %s\n", "Benchmark", "Median", "Noise", "Baseline", "Change", "Status");
+
+    for (size_t c = 0; c < sizeof(bench_cases) / sizeof(bench_cases[0]); c++) {
+        const BenchCase *bench = &bench_cases[c];
+        bool failed = false;
+
+        if (options->filter != NULL && strstr(bench->name, options->filter) == NULL) continue;
+
+        bench->run(&data); // Warm-up: page in inputs and the file cache
+        for (int r = 0; r < runs; r++) {
+            double start = now_seconds();
+            double items = bench->run(&data);
+            double elapsed = now_seconds() - start;
+
+            if (items < 0.0) {
+                failed = true;
+                break;
+            }
+            samples[r] = items / (elapsed > 0.0 ? elapsed : 1e-9);
+        }
+
+        if (failed) {
+            printf("%-24s %19s\n", bench->name, "ERROR");
+            regressions++;
+            continue;
+        }
+
+        BenchResult *result = &results[result_count++];
+        snprintf(result->name, sizeof(result->name), "%s", bench->name);
+        result->median = median_of(samples, runs);
+        for (int r = 0; r < runs; r++) deviations[r] = fabs(samples[r] - result->median);
+        result->relative_mad = median_of(deviations, runs) / result->median;
+
+        const BenchResult *base = find_result(baseline, baseline_count, bench->name);
+        if (base == NULL) {
+            printf("%-24s %11.3e %-7s %7.1f%% %11s %9s  %s\n", bench->name, result->median,
+                   bench->unit, 100.0 * result->relative_mad, "-", "-", "new");
+            continue;
+        }
+
+        // Regression = beyond the threshold and clearly outside the measured
+        // noise; very noisy runs excuse at most MAX_NOISE_ALLOWANCE
+        double change = (result->median - base->median) / base->median;
+        double noise = sqrt(base->relative_mad * base->relative_mad +
+                            result->relative_mad * result->relative_mad);
+        double allowance = fmax(options->threshold_pct / 100.0, fmin(3.0 * noise, MAX_NOISE_ALLOWANCE));
+        bool regressed = -change > allowance;
+        if (regressed) regressions++;
+
+        printf("%-24s %11.3e %-7s %7.1f%% %11.3e %+8.1f%%  %s\n", bench->name, result->median,
+               bench->unit, 100.0 * result->relative_mad, base->median,
+               100.0 * change, regressed ? "REGRESSION" : "ok");
+    }
+
+    // Baseline entries no benchmark answers to (renamed or removed) fail the
+    // gate too; a case that ran and failed was already reported as ERROR
+    for (int b = 0; b < baseline_count; b++) {
+        const char *name = baseline[b].name;
+        if (options->filter != NULL && strstr(name, options->filter) == NULL) continue;
+        if (is_bench_case(name)) continue;
+        printf("%-24s %19s %8s %11.3e %9s  %s\n", name, "-", "-", baseline[b].median, "-", "MISSING");
+        regressions++;
+    }
+
+    free_data(&data);
+    if (options->csv_path == NULL) remove(csv_path);
+
+    if (options->save_baseline_path != NULL) {
+        if (!save_baseline(options->save_baseline_path, results, result_count)) {
+            fprintf(stderr, "Error: Could not write baseline '%s'\n", options->save_baseline_path);
+            return 1;
+        }
+        printf("\nBaseline written to %s\n", options->save_baseline_path);
+    }
+
+    if (regressions > 0) {
+        printf("\n✗ %d benchmark(s) regressed, failed or are missing.\n", regressions);
+        return 2;
+    }
+    if (baseline_count > 0) printf("\n✓ No regressions against %s\n", options->baseline_path);
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// --- Benchmark Configuration ---
+typedef struct {
+    const char *baseline_path;       // Baseline to compare against (NULL = report only)
+    const char *save_baseline_path;  // Where to write this run as a new baseline (NULL = don't)
+    const char *csv_path;            // Test case CSV for the parsing/runner benchmarks (NULL = synthetic)
+    const char *filter;              // Only run benchmarks whose name contains this (NULL = all)
+    int runs;                        // Repetitions per benchmark
+    double threshold_pct;            // Allowed throughput drop before failing
+} BenchmarkOptions;
+
+/**
+ * @brief Runs the benchmark suite and optionally gates it against a baseline file
+ * A benchmark regresses when its median throughput drops more than threshold_pct
+ * below the baseline median AND the drop exceeds 3x the combined run-to-run noise
+ * (median absolute deviation) of both measurements. Noise excuses a drop of at
+ * most 25%: beyond that (and the threshold) a benchmark always regresses.
+ * @param options Benchmark configuration
+ * @return 0 if no regression, 2 if any benchmark regressed, 1 on error
+ */
+int run_benchmarks(const BenchmarkOptions *options);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,807 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include "commandLine.h"
+#include "serverMode.h"
+#include "benchmark.h"
+#include "csvHandler.h"
+#include "testerFile.h"
+#include "shardRunner.h"
+#include "spatialIndex.h"
+#include "convexHull.h"
+#include "resultDiff.h"
+#include "gramMatrix.h"
+#include "queryEngine.h"
+#include "vecvol.h"
+
+#define DEGREES_PER_RADIAN (180.0 / 3.14159265358979323846) // mathUtil.h PI is too coarse for angles near 0
+
+// --- Data Structures ---
+
+// Destination of the streamed --gram tiles
+typedef struct {
+    FILE *file;
+    size_t count;
+} GramOutput;
+
+// --- Helper Prototypes ---
+static void print_usage(const char *program);
+static int command_serve(int argc, char *argv[]);
+static int command_bench(int argc, char *argv[]);
+static int command_contains(int argc, char *argv[]);
+static int command_hull(int argc, char *argv[]);
+static int command_diff(int argc, char *argv[]);
+static double wall_seconds(void);
+static bool load_points(const char *path, PackedVector **points, size_t *count);
+static bool save_points(const char *path, const PackedVector *points, size_t count);
+static bool parse_doubles(const char *text, double *values, int count);
+static int command_transform(int argc, char *argv[]);
+static bool write_gram_tile(const GramTile *tile, void *user_data);
+static int command_gram(int argc, char *argv[]);
+static int command_run(int argc, char *argv[]);
+
+static void print_usage(const char *program) {
+    printf("Usage:\n");
+    printf("  %s                                 Interactive menu\n", program);
+    printf("  %s --serve <socket> [--max-batch N] Run the local request server\n", program);
+    printf("  %s --bench [options]               Run benchmarks, optionally gated by a baseline\n", program);
+    printf("      --runs N             Repetitions per benchmark (default 7)\n");
+    printf("      --baseline FILE      Fail (exit 2) on regressions against FILE\n");
+    printf("      --threshold PCT      Allowed throughput drop in percent (default 10)\n");
+    printf("      --save-baseline FILE Write this run's results as a baseline\n");
+    printf("      --csv FILE           Test case CSV for parsing/runner benchmarks\n");
+    printf("      --filter TEXT        Only run benchmarks whose name contains TEXT\n");
+    printf("  %s --contains SHAPES.csv POINTS.csv [--tolerance T] [--verify]\n", program);
+    printf("      Finds which shapes contain each point (BVH index). SHAPES.csv rows are\n");
+    printf("      O_X,O_Y,O_Z,E1_X,...,E3_Z (origin + 3 edges), POINTS.csv rows are X,Y,Z\n");
+    printf("      (or a .bin points file, see --hull).\n");
+    printf("      --verify also runs the brute force search and compares the results.\n");
+    printf("  %s --hull POINTS [--faces OUT.csv]\n", program);
+    printf("      Convex hull volume and faces of a point cloud. POINTS is a CSV with\n");
+    printf("      X,Y,Z rows, or a .bin file of packed little-endian doubles x,y,z.\n");
+    printf("  %s --diff A B [--abs X] [--rel X] [--ulp N] [--worst K]\n", program);
+    printf("      Compares two result files (CSV with header, or binary) column by column.\n");
+    printf("      A value matches if any tolerance accepts it (default: exact). Exit 2 on differences.\n");
+    printf("  %s --transform IN OUT --matrix M11,M12,...,M33 [--translate X,Y,Z]\n", program);
+    printf("      Applies OUT = M * IN + T to every vector of a points file (CSV or .bin) and\n");
+    printf("      reports det(M), the factor by which every volume scales.\n");
+    printf("  %s --gram POINTS [--top K] [--absolute] [--dot] [--output FILE] [--tile T]\n", program);
+    printf("      All-pairs dot products of a points file (CSV or .bin). --top lists the K most\n");
+    printf("      aligned pairs (--absolute also counts anti-parallel ones). --output streams the\n");
+    printf("      N x N matrix (cosines, or dot products with --dot) to FILE as row-major doubles.\n");
+    printf("  %s --run TEST FILE [--checkpoint STATE] [--every N] [--resume] [--stats]\n", program);
+    printf("  %s --run TEST FILE --shards N|auto [--no-pin] [--stats]\n", program);
+    printf("      Runs one test suite on a CSV file without the menu. TEST is parallelepiped,\n");
+    printf("      pyramid, cross, scalar, or an expression over V1, V2 and V3 such as\n");
+    printf("      \"(V1 x V2) . V3\" or \"normalize(V1 x V2)\" (x cross, . dot, + - * /, dot(),\n");
+    printf("      cross(), norm() or |v|, normalize(), sqrt(), abs()). --checkpoint saves the\n");
+    printf("      position and counters to STATE every N rows (default 100000); --resume\n");
+    printf("      continues from STATE.\n");
+    printf("      --shards splits the file across N worker processes (auto: one per CPU),\n");
+    printf("      spread over the NUMA nodes unless --no-pin is given. --stats adds min/max/\n");
+    printf("      mean/std dev, percentiles and a histogram of the computed values.\n");
+    printf("  %s --run TEST FILE --results OUT.bin\n", program);
+    printf("      Writes volume, cross product, dot products and pass flags of every row\n");
+    printf("      to a binary result file (full precision, readable by --diff).\n");
+    printf("  %s --run TEST FILE [--where EXPR] [--top K] [--by COLUMN] [--asc]\n", program);
+    printf("      Prints only the rows matching EXPR (e.g. \"CROSS_MAG > 100 and V1_X >= 0\"),\n");
+    printf("      or the K largest (--asc: smallest) by COLUMN. Columns: V1_X ... V3_MAG,\n");
+    printf("      EXPECTED_VOLUME, ROW, VOLUME, ERROR, CROSS_MAG, DOT12, DOT13, DOT23, COPLANARITY.\n");
+    printf("  %s --help                          Show this message\n", program);
+}
+
+// --serve <socket> [--max-batch N]
+static int command_serve(int argc, char *argv[]) {
+    ServerOptions options = { .socket_path = NULL, .max_batch = 0 };
+
+    if (argc < 3) {
+        fprintf(stderr, "Error: --serve needs a socket path.\n");
+        return 1;
+    }
+    options.socket_path = argv[2];
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--max-batch") == 0 && i + 1 < argc) {
+            long value = strtol(argv[++i], NULL, 10);
+            if (value <= 0) {
+                fprintf(stderr, "Error: --max-batch must be a positive number.\n");
+                return 1;
+            }
+            options.max_batch = (size_t)value;
+        } else {
+            fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    return run_server(&options);
+}
+
+// --bench [--runs N] [--baseline FILE] [--threshold PCT] [--save-baseline FILE] [--csv FILE] [--filter TEXT]
+static int command_bench(int argc, char *argv[]) {
+    BenchmarkOptions options = {
+        .baseline_path = NULL,
+        .save_baseline_path = NULL,
+        .csv_path = NULL,
+        .filter = NULL,
+        .runs = 7,
+        .threshold_pct = 10.0
+    };
+
+    for (int i = 2; i < argc; i++) {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--runs") == 0 && has_value) {
+            options.runs = atoi(argv[++i]);
+            if (options.runs <= 0) {
+                fprintf(stderr, "Error: --runs must be a positive number.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--baseline") == 0 && has_value) {
+            options.baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && has_value) {
+            options.threshold_pct = atof(argv[++i]);
+            if (options.threshold_pct < 0.0) {
+                fprintf(stderr, "Error: --threshold must not be negative.\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--save-baseline") == 0 && has_value) {
+            options.save_baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && has_value) {
+            options.csv_path = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && has_value) {
+            options.filter = argv[++i];
+        } else {
+            fprintf(stderr, "Error: Unknown or incomplete option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    return run_benchmarks(&options);
+}
+
+// Wall-clock time, so multi-threaded query timings are not summed across threads
+static double wall_seconds(void) {
+#ifdef _WIN32
+    return (double)clock() / CLOCKS_PER_SEC;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+// Points from a .bin file (raw x,y,z doubles) or a CSV with X,Y,Z rows
+static bool load_points(const char *path, PackedVector **points, size_t *count) {
+    size_t length = strlen(path);
+    double *values = NULL;
+
+    if (length < 4 || strcmp(path + length - 4, ".bin") != 0) {
+        if (!csv_load_numeric_rows(path, 3, &values, count)) {
+            fprintf(stderr, "Error reading '%s': %s\n", path, strerror(errno));
+            return false;
+        }
+        *points = (PackedVector*)values;
+        return true;
+    }
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        perror("Error opening file");
+        return false;
+    }
+
+    size_t capacity = 0;
+    *points = NULL;
+    *count = 0;
+    for (;;) {
+        if (*count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 65536;
+            PackedVector *grown = realloc(*points, new_capacity * sizeof(PackedVector));
+            if (grown == NULL) {
+                fprintf(stderr, "Error: Memory reallocation failed.\n");
+                free(*points);
+                fclose(file);
+                return false;
+            }
+            *points = grown;
+            capacity = new_capacity;
+        }
+        size_t read = fread(&(*points)[*count], sizeof(PackedVector), capacity - *count, file);
+        *count += read;
+        if (read == 0 || *count < capacity) break;
+    }
+
+    if (ferror(file)) {
+        perror("Error reading file");
+        free(*points);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    return true;
+}
+
+// Writes points as a .bin file (raw x,y,z doubles) or a CSV with X,Y,Z rows
+static bool save_points(const char *path, const PackedVector *points, size_t count) {
+    size_t length = strlen(path);
+    bool binary = length >= 4 && strcmp(path + length - 4, ".bin") == 0;
+    FILE *file = fopen(path, binary ? "wb" : "w");
+    bool ok;
+
+    if (file == NULL) {
+        perror("Error opening file");
+        return false;
+    }
+
+    if (binary) {
+        ok = fwrite(points, sizeof(PackedVector), count, file) == count;
+    } else {
+        ok = fprintf(file, "X,Y,Z\n") > 0;
+        for (size_t i = 0; ok && i < count; i++) {
+            const double *p = points[i].direction;
+            ok = fprintf(file, "%.17g,%.17g,%.17g\n", p[0], p[1], p[2]) > 0;
+        }
+    }
+
+    if (fclose(file) != 0) ok = false;
+    if (!ok) perror("Error writing file");
+    return ok;
+}
+
+// Parses exactly `count` comma-separated numbers
+static bool parse_doubles(const char *text, double *values, int count) {
+    const char *cursor = text;
+
+    for (int i = 0; i < count; i++) {
+        char *end;
+        values[i] = strtod(cursor, &end);
+        if (end == cursor) return false;
+        cursor = end;
+        if (i + 1 < count) {
+            if (*cursor != ',') return false;
+            cursor++;
+        }
+    }
+    return *cursor == '\0';
+}
+
+// --contains SHAPES.csv POINTS.csv [--tolerance T] [--verify]
+static int command_contains(int argc, char *argv[]) {
+    double tolerance = 0.001;
+    bool verify = false;
+    double *shape_values = NULL;
+    PackedVector *points = NULL;
+    size_t shape_count = 0, point_count = 0;
+    int exit_code = 0;
+
+    if (argc < 4) {
+        fprintf(stderr, "Error: --contains needs a shapes CSV and a points CSV.\n");
+        return 1;
+    }
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else {
+            fprintf(stderr, "Error: Unknown or incomplete option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (!csv_load_numeric_rows(argv[2], 12, &shape_values, &shape_count)) {
+        fprintf(stderr, "Error reading '%s': %s\n", argv[2], strerror(errno));
+        return 1;
+    }
+    if (!load_points(argv[3], &points, &point_count)) {
+        free(shape_values);
+        return 1;
+    }
+
+    // Row-major doubles have the same layout as a Parallelepiped array
+    const Parallelepiped *shapes = (const Parallelepiped*)shape_values;
+    ContainmentResult result = { NULL, NULL, 0 };
+
+    printf("Shapes: %zu | Points: %zu | Tolerance: %g\n", shape_count, point_count, tolerance);
+
+    double start = wall_seconds();
+    SpatialIndex *index = shape_count > 0 ? spatial_index_build(shapes, shape_count, tolerance) : NULL;
+    double build_time = wall_seconds() - start;
+
+    if (index == NULL) {
+        fprintf(stderr, "Error: Could not build the index (no shapes, out of memory or tree too deep).\n");
+        free(shape_values);
+        free(points);
+        return 1;
+    }
+
+    start = wall_seconds();
+    if (!spatial_index_query(index, points, point_count, &result)) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        exit_code = 1;
+    } else {
+        double query_time = wall_seconds() - start;
+        size_t inside_any = 0;
+        for (size_t i = 0; i < point_count; i++) {
+            if (result.row_offsets[i + 1] > result.row_offsets[i]) inside_any++;
+        }
+
+        printf("BVH build: %.3f s | Query: %.3f s\n", build_time, query_time);
+        printf("Points inside at least one shape: %zu | Total containments: %zu\n",
+               inside_any, result.row_offsets[point_count]);
+
+        if (verify) {
+            ContainmentResult reference = { NULL, NULL, 0 };
+            start = wall_seconds();
+            if (!spatial_brute_force_query(shapes, shape_count, tolerance, points, point_count, &reference)) {
+                fprintf(stderr, "Error: Memory allocation failed.\n");
+                exit_code = 1;
+            } else {
+                double brute_time = wall_seconds() - start;
+                bool same = containment_results_equal(&result, &reference);
+                printf("Brute force: %.3f s (%.1fx slower) | Results %s\n", brute_time,
+                       query_time > 0.0 ? brute_time / query_time : 0.0,
+                       same ? "MATCH" : "DIFFER");
+                if (!same) exit_code = 2;
+            }
+            free_containment_result(&reference);
+        }
+    }
+
+    free_containment_result(&result);
+    spatial_index_free(index);
+    free(shape_values);
+    free(points);
+    return exit_code;
+}
+
+// --hull POINTS [--faces OUT.csv]
+static int command_hull(int argc, char *argv[]) {
+    const char *faces_path = NULL;
+    PackedVector *points = NULL;
+    size_t count = 0;
+    ConvexHull hull;
+
+    if (argc < 3) {
+        fprintf(stderr, "Error: --hull needs a points file.\n");
+        return 1;
+    }
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--faces") == 0 && i + 1 < argc) {
+            faces_path = argv[++i];
+        } else {
+            fprintf(stderr, "Error: Unknown or incomplete option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (!load_points(argv[2], &points, &count)) return 1;
+
+    double start = wall_seconds();
+    if (!convex_hull_build(points, count, &hull)) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        free(points);
+        return 1;
+    }
+    double elapsed = wall_seconds() - start;
+
+    printf("Points: %zu\n", count);
+    if (hull.degenerate) {
+        printf("The points span no volume (fewer than 4 distinct points, or all coplanar).\n");
+    } else {
+        printf("Hull vertices: %zu | Faces: %zu\n", hull.vertex_count, hull.face_count);
+    }
+    printf("Volume: %.6f\n", hull.volume);
+    printf("Time: %.3f s (%.3e points/s)\n", elapsed, elapsed > 0.0 ? (double)count / elapsed : 0.0);
+
+    int exit_code = 0;
+    if (faces_path != NULL) {
+        FILE *file = fopen(faces_path, "w");
+        if (file == NULL) {
+            perror("Error opening file");
+            exit_code = 1;
+        } else {
+            // Zero-based indices into the input rows, counter-clockwise seen from outside
+            fprintf(file, "A,B,C\n");
+            for (size_t f = 0; f < hull.face_count; f++) {
+                fprintf(file, "%u,%u,%u\n", (unsigned)hull.faces[f].v[0], (unsigned)hull.faces[f].v[1],
+                        (unsigned)hull.faces[f].v[2]);
+            }
+            fclose(file);
+            printf("Faces written to %s\n", faces_path);
+        }
+    }
+
+    free_convex_hull(&hull);
+    free(points);
+    return exit_code;
+}
+
+// --diff A B [--abs X] [--rel X] [--ulp N] [--worst K]
+static int command_diff(int argc, char *argv[]) {
+    DiffOptions options = { .abs_tolerance = 0.0, .rel_tolerance = 0.0, .ulp_tolerance = 0, .worst_count = 10 };
+
+    if (argc < 4) {
+        fprintf(stderr, "Error: --diff needs two result files.\n");
+        return 1;
+    }
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--abs") == 0 && i + 1 < argc) {
+            options.abs_tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rel") == 0 && i + 1 < argc) {
+            options.rel_tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--ulp") == 0 && i + 1 < argc) {
+            options.ulp_tolerance = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--worst") == 0 && i + 1 < argc) {
+            int value = atoi(argv[++i]);
+            options.worst_count = value < 0 ? 0 : (value > DIFF_MAX_WORST ? DIFF_MAX_WORST : value);
+        } else {
+            fprintf(stderr, "Error: Unknown or incomplete option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+    return run_result_diff(argv[2], argv[3], &options);
+}
+
+// --transform IN OUT --matrix M11,...,M33 [--translate X,Y,Z]
+static int command_transform(int argc, char *argv[]) {
+    double matrix[9], translation[3], determinant;
+    bool has_matrix = false, has_translation = false;
+    PackedVector *points = NULL;
+    size_t count = 0;
+
+    if (argc < 4) {
+        fprintf(stderr, "Error: --transform needs an input and an output file.\n");
+        return 1;
+    }
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--matrix") == 0 && i + 1 < argc) {
+            has_matrix = parse_doubles(argv[++i], matrix, 9);
+            if (!has_matrix) {
+                fprintf(stderr, "Error: --matrix needs 9 comma-separated numbers (row-major).\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--translate") == 0 && i + 1 < argc) {
+            has_translation = parse_doubles(argv[++i], translation, 3);
+            if (!has_translation) {
+                fprintf(stderr, "Error: --translate needs 3 comma-separated numbers.\n");
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Error: Unknown or incomplete option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+    if (!has_matrix) {
+        fprintf(stderr, "Error: --transform needs --matrix.\n");
+        return 1;
+    }
+
+    if (!load_points(argv[2], &points, &count)) return 1;
+
+    // In place: the loaded buffer is the output
+    double start = wall_seconds();
+    VvStatus status = vv_batch_affine_transform(NULL, matrix, has_translation ? translation : NULL,
+                                                (const double*)points, count, (double*)points, &determinant);
+    double elapsed = wall_seconds() - start;
+
+    if (status != VV_OK) {
+        fprintf(stderr, "Error: %s\n", vv_status_string(status));
+        free(points);
+        return 1;
+    }
+
+    printf("Vectors: %zu | Time: %.3f s (%.3e vectors/s)\n", count, elapsed,
+           elapsed > 0.0 ? (double)count / elapsed : 0.0);
+    printf("Determinant: %.10g\n", determinant);
+    printf("Volume scale factor: %.10g (transformed volume = factor x original volume)\n", fabs(determinant));
+    if (determinant < 0.0) printf("The transform mirrors space: orientation (sign of triple products) flips.\n");
+    if (determinant == 0.0) printf("The transform is singular: every transformed volume is 0.\n");
+
+    bool saved = save_points(argv[3], points, count);
+    if (saved) printf("Transformed vectors written to %s\n", argv[3]);
+    free(points);
+    return saved ? 0 : 1;
+}
+
+// Writes one tile into the N x N row-major output file
+static bool write_gram_tile(const GramTile *tile, void *user_data) {
+    GramOutput *output = (GramOutput*)user_data;
+
+    for (size_t r = 0; r < tile->rows; r++) {
+        off_t offset = (off_t)(((tile->row_start + r) * output->count + tile->col_start) * sizeof(double));
+        if (fseeko(output->file, offset, SEEK_SET) != 0 ||
+            fwrite(&tile->values[r * tile->cols], sizeof(double), tile->cols, output->file) != tile->cols) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// --gram POINTS [--top K] [--absolute] [--dot] [--output FILE] [--tile T]
+static int command_gram(int argc, char *argv[]) {
+    const char *output_path = NULL;
+    size_t top = 0, tile_size = 0;
+    bool absolute = false;
+    GramValue value = GRAM_COSINE;
+    PackedVector *points = NULL;
+    size_t count = 0;
+    int exit_code = 0;
+
+    if (argc < 3) {
+        fprintf(stderr, "Error: --gram needs a points file.\n");
+        return 1;
+    }
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            top = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--absolute") == 0) {
+            absolute = true;
+        } else if (strcmp(argv[i], "--dot") == 0) {
+            value = GRAM_DOT;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "--tile") == 0 && i + 1 < argc) {
+            tile_size = strtoul(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "Error: Unknown or incomplete option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+    if (top == 0 && output_path == NULL) {
+        fprintf(stderr, "Error: --gram needs --top and/or --output.\n");
+        return 1;
+    }
+
+    if (!load_points(argv[2], &points, &count)) return 1;
+    double pairs = (double)count * (double)count;
+    printf("Vectors: %zu\n", count);
+
+    if (output_path != NULL) {
+        GramOutput output = { fopen(output_path, "wb"), count };
+        if (output.file == NULL) {
+            perror("Error opening file");
+            free(points);
+            return 1;
+        }
+
+        double start = wall_seconds();
+        bool ok = gram_matrix_tiles(points, count, value, tile_size, false, write_gram_tile, &output);
+        double elapsed = wall_seconds() - start;
+        if (fclose(output.file) != 0) ok = false;
+
+        if (ok) {
+            printf("Matrix: %zu x %zu %s written to %s (%.3f s, %.3e pairs/s)\n", count, count,
+                   value == GRAM_COSINE ? "cosines" : "dot products", output_path, elapsed,
+                   elapsed > 0.0 ? pairs / elapsed : 0.0);
+        } else {
+            fprintf(stderr, "Error: Could not write the matrix to '%s'.\n", output_path);
+            exit_code = 1;
+        }
+    }
+
+    if (top > 0 && exit_code == 0) {
+        // gram_top_aligned never returns more than the N*(N-1)/2 pairs there are
+        size_t pair_total = count < 2 ? 0 : (count % 2 == 0 ? count / 2 * (count - 1) : (count - 1) / 2 * count);
+        size_t capacity = top < pair_total ? top : pair_total;
+        AlignedPair *aligned = (AlignedPair*)malloc((capacity > 0 ? capacity : 1) * sizeof(AlignedPair));
+        size_t found = 0;
+
+        double start = wall_seconds();
+        bool ok = aligned != NULL && gram_top_aligned(points, count, top, absolute, aligned, &found);
+        double elapsed = wall_seconds() - start;
+
+        if (!ok) {
+            fprintf(stderr, "Error: Memory allocation failed (or more than %u vectors).\n", (unsigned)UINT32_MAX);
+            exit_code = 1;
+        } else {
+            printf("Top %zu %s pairs (%.3f s, %.3e pairs/s):\n", found,
+                   absolute ? "aligned or anti-aligned" : "aligned", elapsed,
+                   elapsed > 0.0 ? pairs / 2.0 / elapsed : 0.0);
+            printf("%10s %10s %14s %12s\n", "I", "J", "Cosine", "Angle (deg)");
+            for (size_t p = 0; p < found; p++) {
+                double cosine = aligned[p].cosine;
+                if (cosine > 1.0) cosine = 1.0;
+                if (cosine < -1.0) cosine = -1.0;
+                printf("%10u %10u %14.10f %12.6f\n", (unsigned)aligned[p].i, (unsigned)aligned[p].j,
+                       aligned[p].cosine, acos(cosine) * DEGREES_PER_RADIAN);
+            }
+        }
+        free(aligned);
+    }
+
+    free(points);
+    return exit_code;
+}
+
+// --run TEST FILE [--checkpoint STATE] [--every N] [--resume] [--shards N|auto] [--no-pin] [--stats]
+//                 [--where EXPR] [--top K] [--by COLUMN] [--asc] [--results OUT]
+// TEST is a suite name or an expression
+static int command_run(int argc, char *argv[]) {
+    RunOptions options = { .checkpoint_path = NULL, .checkpoint_interval = 0, .resume = false };
+    Query query = { .condition_count = 0, .top_k = 0, .ascending = false };
+    const char *results_path = NULL;
+    VectorExpr expression;
+    TestSuite suite = TEST_SUITE_PARALLELEPIPED;
+    int shards = 0, exit_code = 1;
+    bool pin = true, collect_stats = false, querying = false, order_given = false, is_expression = false;
+    CsvFile *csv;
+
+    if (argc < 4) {
+        fprintf(stderr, "Error: --run needs a test name and a CSV file.\n");
+        return 1;
+    }
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            options.checkpoint_path = argv[++i];
+        } else if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+            options.checkpoint_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            options.resume = true;
+        } else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+            // Only the literal 'auto' means one shard per CPU; "-1" or "4x" are errors
+            const char *text = argv[++i];
+            char *end;
+            long value = strtol(text, &end, 10);
+            if (strcmp(text, "auto") == 0) {
+                shards = SHARDS_PER_CPU;
+            } else if (end == text || *end != '\0' || value <= 0) {
+                fprintf(stderr, "Error: --shards needs a positive count or 'auto'.\n");
+                return 1;
+            } else {
+                shards = value > MAX_SHARDS ? MAX_SHARDS : (int)value;
+            }
+        } else if (strcmp(argv[i], "--no-pin") == 0) {
+            pin = false;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            collect_stats = true;
+        } else if (strcmp(argv[i], "--where") == 0 && i + 1 < argc) {
+            char error[256];
+            if (!query_parse_where(argv[++i], &query, error, sizeof(error))) {
+                fprintf(stderr, "Error: --where: %s.\n", error);
+                return 1;
+            }
+            querying = true;
+        } else if (strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            long k = atol(argv[++i]);
+            if (k <= 0) {
+                fprintf(stderr, "Error: --top must be a positive number.\n");
+                return 1;
+            }
+            query.top_k = (size_t)k;
+            querying = true;
+        } else if (strcmp(argv[i], "--by") == 0 && i + 1 < argc) {
+            if (!query_column_from_name(argv[++i], &query.order_by)) {
+                fprintf(stderr, "Error: Unknown column '%s' for --by.\n", argv[i]);
+                return 1;
+            }
+            order_given = true;
+            querying = true;
+        } else if (strcmp(argv[i], "--asc") == 0) {
+            query.ascending = true;
+            querying = true;
+        } else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+            results_path = argv[++i];
+        } else {
+            fprintf(stderr, "Error: Unknown or incomplete option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+    if (options.resume && options.checkpoint_path == NULL) {
+        fprintf(stderr, "Error: --resume needs --checkpoint.\n");
+        return 1;
+    }
+    if (shards != 0 && options.checkpoint_path != NULL) {
+        fprintf(stderr, "Error: --shards cannot be combined with --checkpoint.\n");
+        return 1;
+    }
+    if (querying && (shards != 0 || options.checkpoint_path != NULL || collect_stats)) {
+        fprintf(stderr, "Error: Queries cannot be combined with --shards, --checkpoint or --stats.\n");
+        return 1;
+    }
+    if (results_path != NULL && (querying || shards != 0 || options.checkpoint_path != NULL || collect_stats)) {
+        fprintf(stderr, "Error: --results cannot be combined with other --run options.\n");
+        return 1;
+    }
+    if (!test_suite_from_name(argv[2], &suite)) {
+        // Anything else is an expression over V1, V2 and V3
+        char error[256];
+        if (!expr_compile(argv[2], &expression, error, sizeof(error))) {
+            fprintf(stderr, "Error: '%s' is not a test (parallelepiped, pyramid, cross or scalar) "
+                            "or a valid expression: %s.\n", argv[2], error);
+            return 1;
+        }
+        if (querying || results_path != NULL || shards != 0) {
+            fprintf(stderr, "Error: Expressions cannot be combined with --where, --top, --results or --shards.\n");
+            return 1;
+        }
+        is_expression = true;
+    }
+
+    if (results_path != NULL) {
+        csv = csv_open(argv[3]);
+        if (csv != NULL) {
+            exit_code = write_test_results(csv, suite, results_path) ? 0 : 1;
+            csv_close(csv);
+        }
+        return exit_code;
+    }
+    if (querying) {
+        // The suite picks the volume divisor and the default ranking column
+        query.k_value = suite == TEST_SUITE_PYRAMID ? 6.0 : 1.0;
+        if (!order_given) {
+            query.order_by = suite == TEST_SUITE_CROSS_PRODUCT  ? QUERY_COL_CROSS_MAG
+                           : suite == TEST_SUITE_SCALAR_PRODUCT ? QUERY_COL_DOT12
+                                                                : QUERY_COL_VOLUME;
+        }
+        csv = csv_open(argv[3]);
+        if (csv != NULL) {
+            exit_code = run_query(csv, &query);
+            csv_close(csv);
+        }
+        return exit_code;
+    }
+    if (shards != 0) return run_sharded_tests(argv[3], suite, shards, pin, collect_stats);
+
+    if (collect_stats) {
+        options.stats = (ValueStats*)malloc(sizeof(ValueStats));
+        if (options.stats == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed.\n");
+            return 1;
+        }
+        stats_init(options.stats, SKETCH_DEFAULT_ACCURACY);
+    }
+
+    csv = csv_open(argv[3]);
+    if (csv != NULL) {
+        bool complete = is_expression ? run_expression_tests(csv, &expression, &options)
+                                      : run_test_suite(csv, suite, &options);
+        exit_code = complete ? 0 : 1;
+        csv_close(csv);
+    }
+    free(options.stats);
+    return exit_code;
+}
+
+int run_command_line(int argc, char *argv[]) {
+    const char *command = argv[1];
+
+    if (strcmp(command, "--serve") == 0) {
+        return command_serve(argc, argv);
+    }
+    if (strcmp(command, "--bench") == 0) {
+        return command_bench(argc, argv);
+    }
+    if (strcmp(command, "--contains") == 0) {
+        return command_contains(argc, argv);
+    }
+    if (strcmp(command, "--hull") == 0) {
+        return command_hull(argc, argv);
+    }
+    if (strcmp(command, "--diff") == 0) {
+        return command_diff(argc, argv);
+    }
+    if (strcmp(command, "--transform") == 0) {
+        return command_transform(argc, argv);
+    }
+    if (strcmp(command, "--gram") == 0) {
+        return command_gram(argc, argv);
+    }
+    if (strcmp(command, "--run") == 0) {
+        return command_run(argc, argv);
+    }
+    if (strcmp(command, "--help") == 0 || strcmp(command, "-h") == 0) {
+        print_usage(argv[0]);
+        return 0;
+    }
+
+    fprintf(stderr, "Error: Unknown command '%s'\n\n", command);
+    print_usage(argv[0]);
+    return 1;
+}
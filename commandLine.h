@@ -0,0 +1,12 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+/**
+ * @brief Headless entry point used when the calculator is started with arguments
+ * @param argc Argument count from main
+ * @param argv Argument vector from main
+ * @return Process exit code
+ */
+int run_command_line(int argc, char *argv[]);
+
+#endif // COMMAND_LINE_H
@@ -0,0 +1,555 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include "convexHull.h"
+
+#define NO_FACE UINT32_MAX
+#define PARALLEL_PARTITION_MIN 8192
+
+// --- Data Structures ---
+
+// Hull face under construction, with its adjacency and outside set
+typedef struct {
+    uint32_t v[3];
+    uint32_t neighbor[3];      // Face across the edge v[i] -> v[(i + 1) % 3]
+    vector normal;             // Unit outward normal
+    double offset;             // normal · v[0]
+    uint32_t *outside;         // Points above this face that are not on the hull yet
+    size_t outside_count, outside_capacity;
+    uint32_t furthest;         // Outside point with the largest distance
+    double furthest_distance;
+    uint32_t visited;          // Stamp of the last visibility search that found it visible
+    bool alive;
+} BuildFace;
+
+// Edge a -> b between a visible face and the hidden face across it
+typedef struct {
+    uint32_t a, b;
+    uint32_t face;  // Hidden face
+    uint32_t edge;  // Index of the edge b -> a in the hidden face
+} HorizonEdge;
+
+// Step of the iterative depth-first visibility search
+typedef struct {
+    uint32_t face;
+    uint32_t edge;
+    uint32_t remaining;
+} SearchFrame;
+
+typedef struct {
+    const PackedVector *points;
+    size_t point_count;
+    double epsilon;   // Distances up to this count as "on the plane"
+    vector interior;  // Centroid of the initial tetrahedron
+    uint32_t stamp;
+
+    BuildFace *faces;
+    size_t face_count, face_capacity;
+
+    // Scratch buffers reused by every step
+    uint32_t *pending;       size_t pending_count, pending_capacity;
+    uint32_t *visible;       size_t visible_count, visible_capacity;
+    HorizonEdge *horizon;    size_t horizon_count, horizon_capacity;
+    SearchFrame *frames;     size_t frame_count, frame_capacity;
+    uint32_t *candidates;    size_t candidate_count, candidate_capacity;
+    uint32_t *targets;
+    double *distances;       size_t partition_capacity;
+} HullBuilder;
+
+// --- Helper Prototypes ---
+static bool grow_array(void **array, size_t *capacity, size_t needed, size_t element_size);
+static vector point_vector(const HullBuilder *b, uint32_t index);
+static vector subtract(vector lhs, vector rhs);
+static double face_distance(const BuildFace *face, vector point);
+static void set_face_plane(HullBuilder *b, BuildFace *face, const BuildFace *fallback);
+static uint32_t farthest_point(const HullBuilder *b, vector origin, vector axis, bool from_line, double *distance);
+static bool build_initial_simplex(HullBuilder *b, bool *degenerate);
+static bool push_outside(BuildFace *face, uint32_t point, double distance);
+static bool partition_points(HullBuilder *b, const uint32_t *points, size_t count, uint32_t first_face, size_t face_count);
+static uint32_t edge_index(const BuildFace *face, uint32_t from);
+static void discard_furthest(HullBuilder *b, BuildFace *face);
+static bool add_apex(HullBuilder *b, uint32_t seed);
+static bool finish_hull(HullBuilder *b, ConvexHull *hull);
+static void free_builder(HullBuilder *b);
+
+// --- Geometry Helpers ---
+
+static bool grow_array(void **array, size_t *capacity, size_t needed, size_t element_size) {
+    if (needed <= *capacity) return true;
+
+    size_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+
+    void *grown = realloc(*array, new_capacity * element_size);
+    if (grown == NULL) return false;
+    *array = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+static vector point_vector(const HullBuilder *b, uint32_t index) {
+    const double *p = b->points[index].direction;
+    vector v = { { p[0], p[1], p[2] }, 0.0 };
+    return v;
+}
+
+static vector subtract(vector lhs, vector rhs) {
+    vector v = { { lhs.direction[0] - rhs.direction[0],
+                   lhs.direction[1] - rhs.direction[1],
+                   lhs.direction[2] - rhs.direction[2] }, 0.0 };
+    return v;
+}
+
+// Signed distance above the face plane (positive = outside)
+static double face_distance(const BuildFace *face, vector point) {
+    return scalaricProduct(face->normal, point) - face->offset;
+}
+
+// A sliver face whose normal vanishes takes the normal of the hidden face it borders
+static void set_face_plane(HullBuilder *b, BuildFace *face, const BuildFace *fallback) {
+    vector a = point_vector(b, face->v[0]);
+    vector n = crossProduct(subtract(point_vector(b, face->v[1]), a), subtract(point_vector(b, face->v[2]), a));
+
+    if (n.magnitude > 0.0) {
+        for (int i = 0; i < 3; i++) n.direction[i] /= n.magnitude;
+        n.magnitude = 1.0;
+    } else if (fallback != NULL) {
+        n = fallback->normal;
+    }
+    face->normal = n;
+    face->offset = scalaricProduct(n, a);
+}
+
+// Parallel arg-max of the distance to a line (unit direction) or a plane (unit normal).
+// Ties go to the lowest index so the result does not depend on the thread count.
+static uint32_t farthest_point(const HullBuilder *b, vector origin, vector axis, bool from_line, double *distance) {
+    uint32_t best = 0;
+    double best_distance = -1.0;
+
+    #pragma omp parallel
+    {
+        uint32_t local = 0;
+        double local_distance = -1.0;
+
+        #pragma omp for nowait schedule(static)
+        for (long long i = 0; i < (long long)b->point_count; i++) {
+            vector offset = subtract(point_vector(b, (uint32_t)i), origin);
+            double d = from_line ? crossProduct(offset, axis).magnitude : fabs(scalaricProduct(offset, axis));
+            if (d > local_distance) {
+                local_distance = d;
+                local = (uint32_t)i;
+            }
+        }
+
+        #pragma omp critical(hull_farthest)
+        {
+            if (local_distance > best_distance || (local_distance == best_distance && local < best)) {
+                best_distance = local_distance;
+                best = local;
+            }
+        }
+    }
+
+    *distance = best_distance;
+    return best;
+}
+
+// --- Construction ---
+
+static bool build_initial_simplex(HullBuilder *b, bool *degenerate) {
+    uint32_t extremes[6] = { 0, 0, 0, 0, 0, 0 }; // min x, max x, min y, max y, min z, max z
+    double max_abs[3] = { 0.0, 0.0, 0.0 };
+    const PackedVector *p = b->points;
+
+    *degenerate = true;
+
+    #pragma omp parallel
+    {
+        uint32_t local[6] = { 0, 0, 0, 0, 0, 0 };
+        double local_abs[3] = { 0.0, 0.0, 0.0 };
+
+        #pragma omp for nowait schedule(static)
+        for (long long i = 0; i < (long long)b->point_count; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                double value = p[i].direction[axis];
+                if (value < p[local[2 * axis]].direction[axis]) local[2 * axis] = (uint32_t)i;
+                if (value > p[local[2 * axis + 1]].direction[axis]) local[2 * axis + 1] = (uint32_t)i;
+                if (fabs(value) > local_abs[axis]) local_abs[axis] = fabs(value);
+            }
+        }
+
+        #pragma omp critical(hull_extremes)
+        {
+            for (int axis = 0; axis < 3; axis++) {
+                double low = p[local[2 * axis]].direction[axis], high = p[local[2 * axis + 1]].direction[axis];
+                double best_low = p[extremes[2 * axis]].direction[axis], best_high = p[extremes[2 * axis + 1]].direction[axis];
+                if (low < best_low || (low == best_low && local[2 * axis] < extremes[2 * axis])) {
+                    extremes[2 * axis] = local[2 * axis];
+                }
+                if (high > best_high || (high == best_high && local[2 * axis + 1] < extremes[2 * axis + 1])) {
+                    extremes[2 * axis + 1] = local[2 * axis + 1];
+                }
+                if (local_abs[axis] > max_abs[axis]) max_abs[axis] = local_abs[axis];
+            }
+        }
+    }
+
+    // Rounding error bound of a plane distance at this coordinate scale
+    b->epsilon = 3.0 * DBL_EPSILON * (max_abs[0] + max_abs[1] + max_abs[2]);
+
+    // The two most distant extremes span the first edge
+    uint32_t s[4] = { extremes[0], extremes[1], 0, 0 };
+    double best = -1.0;
+    for (int i = 0; i < 6; i++) {
+        for (int j = i + 1; j < 6; j++) {
+            vector d = subtract(point_vector(b, extremes[i]), point_vector(b, extremes[j]));
+            double length = scalaricProduct(d, d);
+            if (length > best) {
+                best = length;
+                s[0] = extremes[i];
+                s[1] = extremes[j];
+            }
+        }
+    }
+    if (sqrt(best) <= b->epsilon) return true;
+
+    double distance;
+    vector origin = point_vector(b, s[0]);
+    vector axis = subtract(point_vector(b, s[1]), origin);
+    double length = sqrt(scalaricProduct(axis, axis));
+    for (int i = 0; i < 3; i++) axis.direction[i] /= length;
+
+    s[2] = farthest_point(b, origin, axis, true, &distance);
+    if (distance <= b->epsilon) return true;
+
+    vector normal = crossProduct(subtract(point_vector(b, s[1]), origin), subtract(point_vector(b, s[2]), origin));
+    for (int i = 0; i < 3; i++) normal.direction[i] /= normal.magnitude;
+
+    s[3] = farthest_point(b, origin, normal, false, &distance);
+    if (distance <= b->epsilon) return true;
+
+    *degenerate = false;
+    if (!grow_array((void**)&b->faces, &b->face_capacity, 4, sizeof(BuildFace))) return false;
+
+    for (int i = 0; i < 3; i++) {
+        b->interior.direction[i] = 0.25 * (b->points[s[0]].direction[i] + b->points[s[1]].direction[i] +
+                                           b->points[s[2]].direction[i] + b->points[s[3]].direction[i]);
+    }
+    b->interior.magnitude = 0.0;
+
+    // Face f is opposite s[f], oriented so s[f] is below it
+    for (int f = 0; f < 4; f++) {
+        BuildFace *face = &b->faces[f];
+        int k = 0;
+        memset(face, 0, sizeof(*face));
+        for (int i = 0; i < 4; i++) {
+            if (i != f) face->v[k++] = s[i];
+        }
+        set_face_plane(b, face, NULL);
+        if (face_distance(face, point_vector(b, s[f])) > 0.0) {
+            uint32_t swap = face->v[1];
+            face->v[1] = face->v[2];
+            face->v[2] = swap;
+            set_face_plane(b, face, NULL);
+        }
+        face->alive = true;
+    }
+
+    // Neighbor across a -> b is the face holding b -> a
+    for (int f = 0; f < 4; f++) {
+        for (int e = 0; e < 3; e++) {
+            uint32_t from = b->faces[f].v[e], to = b->faces[f].v[(e + 1) % 3];
+            for (int g = 0; g < 4; g++) {
+                for (int h = 0; h < 3; h++) {
+                    if (b->faces[g].v[h] == to && b->faces[g].v[(h + 1) % 3] == from) b->faces[f].neighbor[e] = (uint32_t)g;
+                }
+            }
+        }
+    }
+    b->face_count = 4;
+    return true;
+}
+
+static bool push_outside(BuildFace *face, uint32_t point, double distance) {
+    if (!grow_array((void**)&face->outside, &face->outside_capacity, face->outside_count + 1, sizeof(uint32_t))) {
+        return false;
+    }
+    if (face->outside_count == 0 || distance > face->furthest_distance) {
+        face->furthest = point;
+        face->furthest_distance = distance;
+    }
+    face->outside[face->outside_count++] = point;
+    return true;
+}
+
+// Hands each point to the first new face it lies above; points above none are
+// inside the hull (or on it, within epsilon) and are dropped for good.
+static bool partition_points(HullBuilder *b, const uint32_t *points, size_t count, uint32_t first_face, size_t face_count) {
+    if (count == 0) return true;
+    if (count > b->partition_capacity) {
+        uint32_t *targets = realloc(b->targets, count * sizeof(uint32_t));
+        if (targets != NULL) b->targets = targets;
+        double *distances = realloc(b->distances, count * sizeof(double));
+        if (distances != NULL) b->distances = distances;
+        if (targets == NULL || distances == NULL) return false;
+        b->partition_capacity = count;
+    }
+
+    #pragma omp parallel for schedule(static) if(count >= PARALLEL_PARTITION_MIN)
+    for (long long i = 0; i < (long long)count; i++) {
+        vector p = point_vector(b, points[i]);
+        b->targets[i] = NO_FACE;
+        for (uint32_t f = first_face; f < first_face + face_count; f++) {
+            double d = face_distance(&b->faces[f], p);
+            if (d > b->epsilon) {
+                b->targets[i] = f;
+                b->distances[i] = d;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (b->targets[i] != NO_FACE && !push_outside(&b->faces[b->targets[i]], points[i], b->distances[i])) return false;
+    }
+    return true;
+}
+
+// Index of the edge of a face that starts at the given vertex
+static uint32_t edge_index(const BuildFace *face, uint32_t from) {
+    return face->v[0] == from ? 0 : (face->v[1] == from ? 1 : 2);
+}
+
+// Drops the furthest point of a face whose visible region is not a clean disc
+static void discard_furthest(HullBuilder *b, BuildFace *face) {
+    uint32_t dropped = face->furthest;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < face->outside_count; i++) {
+        uint32_t point = face->outside[i];
+        if (point == dropped) continue;
+
+        double d = face_distance(face, point_vector(b, point));
+        if (kept == 0 || d > face->furthest_distance) {
+            face->furthest = point;
+            face->furthest_distance = d;
+        }
+        face->outside[kept++] = point;
+    }
+    face->outside_count = kept;
+}
+
+// One quickhull step: the furthest outside point of the seed face becomes a hull vertex
+static bool add_apex(HullBuilder *b, uint32_t seed) {
+    uint32_t apex = b->faces[seed].furthest;
+    vector eye = point_vector(b, apex);
+
+    // Depth-first search over the faces visible from the apex; the hidden
+    // faces it stops at give the horizon, in counter-clockwise order
+    b->stamp++;
+    b->visible_count = b->horizon_count = b->frame_count = 0;
+    if (!grow_array((void**)&b->visible, &b->visible_capacity, 1, sizeof(uint32_t)) ||
+        !grow_array((void**)&b->frames, &b->frame_capacity, 1, sizeof(SearchFrame))) return false;
+    b->faces[seed].visited = b->stamp;
+    b->visible[b->visible_count++] = seed;
+    b->frames[b->frame_count++] = (SearchFrame){ seed, 0, 3 };
+
+    while (b->frame_count > 0) {
+        SearchFrame *top = &b->frames[b->frame_count - 1];
+        if (top->remaining == 0) {
+            b->frame_count--;
+            continue;
+        }
+
+        uint32_t f = top->face, e = top->edge;
+        top->edge = (e + 1) % 3;
+        top->remaining--;
+
+        uint32_t from = b->faces[f].v[e], to = b->faces[f].v[(e + 1) % 3];
+        uint32_t across = b->faces[f].neighbor[e];
+        if (b->faces[across].visited == b->stamp) continue;
+
+        uint32_t back = edge_index(&b->faces[across], to);
+        if (face_distance(&b->faces[across], eye) > b->epsilon) {
+            if (!grow_array((void**)&b->visible, &b->visible_capacity, b->visible_count + 1, sizeof(uint32_t)) ||
+                !grow_array((void**)&b->frames, &b->frame_capacity, b->frame_count + 1, sizeof(SearchFrame))) return false;
+            b->faces[across].visited = b->stamp;
+            b->visible[b->visible_count++] = across;
+            b->frames[b->frame_count++] = (SearchFrame){ across, (back + 1) % 3, 2 };
+        } else {
+            if (!grow_array((void**)&b->horizon, &b->horizon_capacity, b->horizon_count + 1, sizeof(HorizonEdge))) return false;
+            b->horizon[b->horizon_count++] = (HorizonEdge){ from, to, across, back };
+        }
+    }
+
+    // Near-degenerate input can make the visible region wrap around a hidden
+    // face; its horizon is then not one loop. Drop the point as coplanar.
+    for (size_t i = 0; i < b->horizon_count; i++) {
+        if (b->horizon[i].b != b->horizon[(i + 1) % b->horizon_count].a) {
+            discard_furthest(b, &b->faces[seed]);
+            return true;
+        }
+    }
+
+    // Outside points of the visible faces are re-partitioned onto the new faces
+    b->candidate_count = 0;
+    for (size_t i = 0; i < b->visible_count; i++) {
+        BuildFace *face = &b->faces[b->visible[i]];
+        if (!grow_array((void**)&b->candidates, &b->candidate_capacity,
+                        b->candidate_count + face->outside_count, sizeof(uint32_t))) return false;
+        for (size_t k = 0; k < face->outside_count; k++) {
+            if (face->outside[k] != apex) b->candidates[b->candidate_count++] = face->outside[k];
+        }
+        free(face->outside);
+        face->outside = NULL;
+        face->outside_count = face->outside_capacity = 0;
+        face->alive = false;
+    }
+
+    // Fan of new faces from the horizon to the apex
+    size_t h = b->horizon_count;
+    uint32_t first = (uint32_t)b->face_count;
+    if (b->face_count + h > UINT32_MAX - 1 ||
+        !grow_array((void**)&b->faces, &b->face_capacity, b->face_count + h, sizeof(BuildFace)) ||
+        !grow_array((void**)&b->pending, &b->pending_capacity, b->pending_count + h, sizeof(uint32_t))) return false;
+
+    for (size_t i = 0; i < h; i++) {
+        const HorizonEdge *edge = &b->horizon[i];
+        BuildFace *face = &b->faces[first + i];
+
+        memset(face, 0, sizeof(*face));
+        face->v[0] = edge->a;
+        face->v[1] = edge->b;
+        face->v[2] = apex;
+        face->neighbor[0] = edge->face;
+        face->neighbor[1] = first + (uint32_t)((i + 1) % h);
+        face->neighbor[2] = first + (uint32_t)((i + h - 1) % h);
+        face->alive = true;
+        set_face_plane(b, face, &b->faces[edge->face]);
+        b->faces[edge->face].neighbor[edge->edge] = first + (uint32_t)i;
+    }
+    b->face_count += h;
+
+    if (!partition_points(b, b->candidates, b->candidate_count, first, h)) return false;
+
+    for (size_t i = 0; i < h; i++) {
+        if (b->faces[first + i].outside_count > 0) b->pending[b->pending_count++] = first + (uint32_t)i;
+    }
+    return true;
+}
+
+static bool finish_hull(HullBuilder *b, ConvexHull *hull) {
+    size_t count = 0;
+    for (size_t f = 0; f < b->face_count; f++) {
+        if (b->faces[f].alive) count++;
+    }
+
+    hull->faces = (HullFace*)malloc(count * sizeof(HullFace));
+    bool *used = (bool*)calloc(b->point_count, sizeof(bool));
+    double *face_volumes = (double*)malloc((count ? count : 1) * sizeof(double));
+    if (hull->faces == NULL || used == NULL || face_volumes == NULL) {
+        free(used);
+        free(face_volumes);
+        return false;
+    }
+
+    for (size_t f = 0; f < b->face_count; f++) {
+        if (!b->faces[f].alive) continue;
+        for (int i = 0; i < 3; i++) {
+            hull->faces[hull->face_count].v[i] = b->faces[f].v[i];
+            if (!used[b->faces[f].v[i]]) {
+                used[b->faces[f].v[i]] = true;
+                hull->vertex_count++;
+            }
+        }
+        hull->face_count++;
+    }
+    free(used);
+
+    // Sum of the tetrahedra from the interior point: |(A-O) x (B-O) · (C-O)| / 6.
+    // The tetrahedra are computed in parallel but added in face order, so the
+    // volume is the same for any thread count.
+    #pragma omp parallel for schedule(static)
+    for (long long f = 0; f < (long long)hull->face_count; f++) {
+        vector edges[3];
+        for (int i = 0; i < 3; i++) edges[i] = subtract(point_vector(b, hull->faces[f].v[i]), b->interior);
+        face_volumes[f] = volumeParallelepiped(edges, 6.0);
+    }
+    double volume = 0.0;
+    for (size_t f = 0; f < hull->face_count; f++) volume += face_volumes[f];
+    free(face_volumes);
+    hull->volume = volume;
+    return true;
+}
+
+static void free_builder(HullBuilder *b) {
+    for (size_t f = 0; f < b->face_count; f++) free(b->faces[f].outside);
+    free(b->faces);
+    free(b->pending);
+    free(b->visible);
+    free(b->horizon);
+    free(b->frames);
+    free(b->candidates);
+    free(b->targets);
+    free(b->distances);
+}
+
+bool convex_hull_build(const PackedVector *points, size_t count, ConvexHull *hull) {
+    HullBuilder b;
+    bool degenerate, ok;
+
+    if (hull == NULL) return false;
+    memset(hull, 0, sizeof(*hull));
+    hull->degenerate = true;
+    if (points == NULL && count > 0) return false;
+    if (count < 4) return true; // Too few points to span a volume
+    if (count > UINT32_MAX) return false;
+
+    memset(&b, 0, sizeof(b));
+    b.points = points;
+    b.point_count = count;
+
+    ok = build_initial_simplex(&b, &degenerate);
+    if (ok && !degenerate) {
+        hull->degenerate = false;
+
+        uint32_t *all = (uint32_t*)malloc(count * sizeof(uint32_t));
+        ok = all != NULL && grow_array((void**)&b.pending, &b.pending_capacity, 4, sizeof(uint32_t));
+        if (ok) {
+            for (size_t i = 0; i < count; i++) all[i] = (uint32_t)i;
+            ok = partition_points(&b, all, count, 0, 4);
+        }
+        free(all);
+
+        for (uint32_t f = 0; ok && f < 4; f++) {
+            if (b.faces[f].outside_count > 0) b.pending[b.pending_count++] = f;
+        }
+
+        while (ok && b.pending_count > 0) {
+            uint32_t f = b.pending[--b.pending_count];
+            if (!b.faces[f].alive || b.faces[f].outside_count == 0) continue;
+            ok = add_apex(&b, f);
+            if (ok && b.faces[f].alive && b.faces[f].outside_count > 0) {
+                ok = grow_array((void**)&b.pending, &b.pending_capacity, b.pending_count + 1, sizeof(uint32_t));
+                if (ok) b.pending[b.pending_count++] = f;
+            }
+        }
+
+        if (ok) ok = finish_hull(&b, hull);
+    }
+
+    free_builder(&b);
+    if (!ok) free_convex_hull(hull);
+    return ok;
+}
+
+void free_convex_hull(ConvexHull *hull) {
+    if (hull == NULL) return;
+    free(hull->faces);
+    hull->faces = NULL;
+    hull->face_count = 0;
+    hull->vertex_count = 0;
+    hull->volume = 0.0;
+}
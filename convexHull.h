@@ -0,0 +1,46 @@
+#ifndef CONVEX_HULL_H
+#define CONVEX_HULL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "mathUtil.h"
+
+// --- Data Structures ---
+
+// Triangle of the hull: indices into the input points, counter-clockwise seen from outside
+typedef struct {
+    uint32_t v[3];
+} HullFace;
+
+typedef struct {
+    HullFace *faces;
+    size_t face_count;
+    size_t vertex_count; // Distinct input points used by the faces
+    double volume;
+    bool degenerate;     // All points coplanar, collinear or equal: no faces, volume 0
+} ConvexHull;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Computes the 3D convex hull of a point cloud with quickhull.
+ * Points closer than a relative epsilon to a face plane count as coplanar and
+ * are left out of the hull, so coplanar and duplicate points are safe. The
+ * per-point passes (extremes, partitioning) run in parallel with OpenMP; the
+ * hull expansion itself is sequential.
+ * The volume is the sum of the tetrahedra between an interior point and each
+ * face, each computed with volumeParallelepiped(..., 6).
+ * @param points Input points
+ * @param count Number of points (at most UINT32_MAX)
+ * @param hull Receives the hull (free with free_convex_hull)
+ * @return true on success (including degenerate inputs), false on allocation failure
+ */
+bool convex_hull_build(const PackedVector *points, size_t count, ConvexHull *hull);
+
+/**
+ * @brief Frees the faces of a ConvexHull
+ */
+void free_convex_hull(ConvexHull *hull);
+
+#endif // CONVEX_HULL_H
@@ -1,80 +1,621 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "csvHandler.h"
 #include <math.h> 
+#include <errno.h>
+#include <ctype.h>
 
-// Helper function to read a single vector from the current line's tokens
-static bool read_single_vector(CsvFile *csv, vector *v_out) {
-    char *field_str;
+#if (defined(CSV_HAVE_ZLIB) || defined(CSV_HAVE_ZSTD)) && !defined(_WIN32)
+#define CSV_HAVE_DECOMPRESSION
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+#ifdef CSV_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CSV_HAVE_ZSTD
+#include <zstd.h>
+#endif
 
-    if (!csv || !v_out) return false;
+#ifdef _WIN32
+#define fseeko _fseeki64
+#define ftello _ftelli64
+#endif
 
-    // 1. Read X component
-    field_str = csv_get_field(csv);
-    if (field_str == NULL) return false;
-    v_out->direction[0] = atof(field_str);
+#ifndef ENOTSUP
+#define ENOTSUP ENOSYS
+#endif
 
-    // 2. Read Y component
-    field_str = csv_get_field(csv);
-    if (field_str == NULL) return false;
-    v_out->direction[1] = atof(field_str);
+#define CSV_DECODE_CHUNK (256 * 1024) // Bytes handed to the parser per pipe write
+#define CSV_STREAM_BUFFER (256 * 1024)
 
-    // 3. Read Z component
-    field_str = csv_get_field(csv);
-    if (field_str == NULL) return false;
-    v_out->direction[2] = atof(field_str);
+// --- Compressed Input ---
+
+typedef enum {
+    CSV_PLAIN,
+    CSV_GZIP,
+    CSV_ZSTD
+} CsvCompression;
+
+// Recognizes gzip (1f 8b) and zstd (28 b5 2f fd) by their magic bytes
+static CsvCompression detect_compression(const unsigned char *magic, size_t length) {
+    if (length >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) return CSV_GZIP;
+    if (length >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) return CSV_ZSTD;
+    return CSV_PLAIN;
+}
+
+static bool compression_supported(CsvCompression format) {
+#ifdef CSV_HAVE_DECOMPRESSION
+#ifdef CSV_HAVE_ZLIB
+    if (format == CSV_GZIP) return true;
+#endif
+#ifdef CSV_HAVE_ZSTD
+    if (format == CSV_ZSTD) return true;
+#endif
+#endif
+    return format == CSV_PLAIN;
+}
+
+#ifdef CSV_HAVE_DECOMPRESSION
+
+// The decoder thread writes decompressed bytes into a pipe whose read end is
+// the CsvFile's file_ptr, so the line parser is the same for every input.
+// Closing the read end stops the thread: its next write fails with EPIPE.
+struct CsvDecoder {
+    char *path;
+    CsvCompression format;
+    pthread_t thread;
+    int write_fd;
+    bool running; // Thread started and not joined yet
+    bool failed;  // Corrupt or unreadable input (valid after the thread is joined)
+};
+
+static bool write_all(int fd, const char *data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        length -= (size_t)written;
+    }
+    return true;
+}
+
+#ifdef CSV_HAVE_ZLIB
+// gzread also handles concatenated gzip members
+static bool decode_gzip(CsvDecoder *decoder, char *buffer) {
+    gzFile gz = gzopen(decoder->path, "rb");
+    bool ok = true;
+    int read;
+
+    if (gz == NULL) return false;
+    gzbuffer(gz, CSV_DECODE_CHUNK);
+    while ((read = gzread(gz, buffer, CSV_DECODE_CHUNK)) > 0) {
+        if (!write_all(decoder->write_fd, buffer, (size_t)read)) break; // Reader closed
+    }
+    // A truncated member ends reads early and shows up as Z_BUF_ERROR
+    int error = Z_OK;
+    gzerror(gz, &error);
+    if (read < 0 || (error != Z_OK && error != Z_STREAM_END)) ok = false;
+    gzclose(gz);
+    return ok;
+}
+#endif
+
+#ifdef CSV_HAVE_ZSTD
+static bool decode_zstd(CsvDecoder *decoder, char *buffer) {
+    size_t in_capacity = ZSTD_DStreamInSize();
+    char *in_buffer = (char*)malloc(in_capacity);
+    ZSTD_DStream *stream = ZSTD_createDStream();
+    FILE *file = fopen(decoder->path, "rb");
+    size_t last_result = 0, read;
+    bool ok = in_buffer != NULL && stream != NULL && file != NULL;
+
+    if (ok) ZSTD_initDStream(stream);
+    while (ok && (read = fread(in_buffer, 1, in_capacity, file)) > 0) {
+        ZSTD_inBuffer input = { in_buffer, read, 0 };
+        while (ok && input.pos < input.size) {
+            ZSTD_outBuffer output = { buffer, CSV_DECODE_CHUNK, 0 };
+            last_result = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(last_result)) {
+                ok = false;
+            } else if (!write_all(decoder->write_fd, buffer, output.pos)) {
+                break; // Reader closed
+            }
+        }
+        if (input.pos < input.size) break;
+    }
+    if (ok && file != NULL && ferror(file)) ok = false;
+    if (ok && last_result != 0 && feof(file)) ok = false; // Truncated frame
+
+    if (file != NULL) fclose(file);
+    ZSTD_freeDStream(stream);
+    free(in_buffer);
+    return ok;
+}
+#endif
+
+static void *decoder_thread(void *argument) {
+    CsvDecoder *decoder = (CsvDecoder*)argument;
+    char *buffer = (char*)malloc(CSV_DECODE_CHUNK);
+    sigset_t pipe_signal;
+
+    // A closed reader must show up as EPIPE here, not kill the process
+    sigemptyset(&pipe_signal);
+    sigaddset(&pipe_signal, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipe_signal, NULL);
+
+    decoder->failed = buffer == NULL;
+#ifdef CSV_HAVE_ZLIB
+    if (buffer != NULL && decoder->format == CSV_GZIP) decoder->failed = !decode_gzip(decoder, buffer);
+#endif
+#ifdef CSV_HAVE_ZSTD
+    if (buffer != NULL && decoder->format == CSV_ZSTD) decoder->failed = !decode_zstd(decoder, buffer);
+#endif
+
+    free(buffer);
+    close(decoder->write_fd); // End of file for the parser
+    return NULL;
+}
+
+// Starts (or restarts) decoding into a fresh pipe that becomes csv->file_ptr
+static bool start_decoder(CsvFile *csv) {
+    CsvDecoder *decoder = csv->decoder;
+    int fds[2];
+
+    if (pipe(fds) != 0) return false;
+    csv->file_ptr = fdopen(fds[0], "r");
+    if (csv->file_ptr == NULL) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    setvbuf(csv->file_ptr, NULL, _IOFBF, CSV_STREAM_BUFFER);
+
+    decoder->write_fd = fds[1];
+    decoder->failed = false;
+    if (pthread_create(&decoder->thread, NULL, decoder_thread, decoder) != 0) {
+        fclose(csv->file_ptr);
+        close(fds[1]);
+        csv->file_ptr = NULL;
+        return false;
+    }
+    decoder->running = true;
+    return true;
+}
+
+// Called at the pipe's end of file: the thread has closed its end and is
+// finishing, so joining it tells a clean end from a corrupt or truncated input
+static void finish_decoder(CsvFile *csv) {
+    CsvDecoder *decoder = csv->decoder;
+
+    if (!decoder->running) return;
+    pthread_join(decoder->thread, NULL);
+    decoder->running = false;
+    if (decoder->failed) {
+        snprintf(csv->error, sizeof(csv->error), "Could not decompress '%s' (corrupt or truncated)", decoder->path);
+    }
+}
+
+// Stops decoding early; a failure after the lines already read does not matter
+static void stop_decoder(CsvFile *csv) {
+    if (csv->file_ptr != NULL) {
+        fclose(csv->file_ptr);
+        csv->file_ptr = NULL;
+    }
+    if (csv->decoder->running) {
+        pthread_join(csv->decoder->thread, NULL);
+        csv->decoder->running = false;
+    }
+}
+
+static bool open_decoder(CsvFile *csv, const char *filename, CsvCompression format) {
+    CsvDecoder *decoder = (CsvDecoder*)calloc(1, sizeof(CsvDecoder));
+    if (decoder == NULL) return false;
+
+    decoder->path = (char*)malloc(strlen(filename) + 1);
+    if (decoder->path == NULL) {
+        free(decoder);
+        return false;
+    }
+    strcpy(decoder->path, filename);
+    decoder->format = format;
+
+    csv->decoder = decoder;
+    if (!start_decoder(csv)) {
+        free(decoder->path);
+        free(decoder);
+        csv->decoder = NULL;
+        return false;
+    }
+    return true;
+}
+
+static void close_decoder(CsvFile *csv) {
+    stop_decoder(csv);
+    free(csv->decoder->path);
+    free(csv->decoder);
+    csv->decoder = NULL;
+}
+
+#endif // CSV_HAVE_DECOMPRESSION
+
+// Case-insensitive comparison of the first `length` characters
+static int strncasecmp_portable(const char *a, const char *b, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        int ca = tolower((unsigned char)a[i]), cb = tolower((unsigned char)b[i]);
+        if (ca != cb || ca == '\0') return ca - cb;
+    }
+    return 0;
+}
+
+// Fills the 13-column positional layout used when a file has no usable header
+static void set_positional_map(CsvColumnMap *map) {
+    for (int p = 0; p < CSV_MAX_FIELDS; p++) map->position_column[p] = -1;
+    for (int c = 0; c < CSV_COLUMN_COUNT; c++) {
+        map->field_index[c] = c;
+        map->position_column[c] = (signed char)c;
+    }
+}
+
+// Parses one coordinate field. Integer literals (optionally followed by
+// ".000") are decoded exactly without going through atof.
+// Returns true if the field held an integer within EXACT_COORD_LIMIT.
+static bool parse_coordinate(const char *field_str, double *value, long long *int_value) {
+    char *end;
+    errno = 0;
+    long long parsed = strtoll(field_str, &end, 10);
+
+    if (end != field_str && errno == 0) {
+        const char *rest = end;
+        if (*rest == '.') {
+            rest++;
+            while (*rest == '0') rest++;
+        }
+        while (*rest == ' ' || *rest == '\t') rest++;
+
+        if (*rest == '\0' && parsed <= EXACT_COORD_LIMIT && parsed >= -EXACT_COORD_LIMIT) {
+            *value = (double)parsed;
+            *int_value = parsed;
+            return true;
+        }
+    }
+
+    *value = atof(field_str);
+    return false;
+}
+
+// Helper function to read a single vector from the current line's tokens.
+// int_out (optional) receives the exact coordinates, *all_integer is cleared
+// as soon as one coordinate is not an integer.
+static bool read_single_vector(CsvFile *csv, vector *v_out, long long int_out[3], bool *all_integer) {
+    char *field_str;
+    long long ignored[3];
+    bool integer = true;
+
+    if (!csv || !v_out) return false;
+    if (int_out == NULL) int_out = ignored;
+
+    // 1-3. Read X, Y, Z components
+    for (int i = 0; i < 3; i++) {
+        field_str = csv_get_field(csv);
+        if (field_str == NULL || *field_str == '\0') return false;
+        if (!parse_coordinate(field_str, &v_out->direction[i], &int_out[i])) integer = false;
+    }
 
     // 4. Read Magnitude
     field_str = csv_get_field(csv);
     if (field_str == NULL) return false;
     v_out->magnitude = atof(field_str);
 
+    if (all_integer != NULL && !integer) *all_integer = false;
     return true;
 }
 
 // --- Core CSV Function Implementations ---
 
 CsvFile* csv_open(const char *filename) {
-    CsvFile *csv = (CsvFile*)malloc(sizeof(CsvFile));
-    if (csv == NULL) {
-        perror("Memory allocation failed");
+    CsvFile *csv = csv_open_quiet(filename);
+    if (csv == NULL && errno == ENOTSUP) {
+        fprintf(stderr, "Error opening CSV file: '%s' is compressed; rebuild with -DCSV_HAVE_ZLIB -lz "
+                        "(gzip) or -DCSV_HAVE_ZSTD -lzstd (zstd).\n", filename);
+    } else if (csv == NULL) {
+        perror("Error opening CSV file");
+    }
+    return csv;
+}
+
+CsvFile* csv_open_quiet(const char *filename) {
+    if (filename == NULL) {
+        errno = EINVAL;
         return NULL;
     }
 
+    CsvFile *csv = (CsvFile*)malloc(sizeof(CsvFile));
+    if (csv == NULL) return NULL;
+
+    csv->decoder = NULL;
     csv->file_ptr = fopen(filename, "r");
     if (csv->file_ptr == NULL) {
-        perror("Error opening CSV file");
+        int saved_errno = errno;
         free(csv); 
+        errno = saved_errno;
         return NULL;
     }
 
+    // Peek at the magic bytes to spot compressed input
+    unsigned char magic[4];
+    size_t magic_length = fread(magic, 1, sizeof(magic), csv->file_ptr);
+    CsvCompression format = detect_compression(magic, magic_length);
+    rewind(csv->file_ptr);
+
+    if (format != CSV_PLAIN) {
+        fclose(csv->file_ptr);
+        csv->file_ptr = NULL;
+        if (!compression_supported(format)) {
+            free(csv);
+            errno = ENOTSUP;
+            return NULL;
+        }
+#ifdef CSV_HAVE_DECOMPRESSION
+        if (!open_decoder(csv, filename, format)) {
+            int saved_errno = errno;
+            free(csv);
+            errno = saved_errno;
+            return NULL;
+        }
+#endif
+    }
+
     csv->current_line_number = 0;
+    csv->line_buffer[0] = '\0';
+    csv->field_cursor = NULL;
+    csv->error[0] = '\0';
+    set_positional_map(&csv->columns);
 
     return csv;
 }
 
+void csv_rewind(CsvFile *csv) {
+    if (csv == NULL) return;
+    csv->current_line_number = 0;
+    csv->field_cursor = NULL;
+    csv->error[0] = '\0';
+#ifdef CSV_HAVE_DECOMPRESSION
+    if (csv->decoder != NULL) {
+        // A pipe cannot seek: decode again from the start
+        stop_decoder(csv);
+        if (!start_decoder(csv)) {
+            snprintf(csv->error, sizeof(csv->error), "Could not restart decompression of '%s'", csv->decoder->path);
+        }
+        return;
+    }
+#endif
+    rewind(csv->file_ptr);
+}
+
+CsvPosition csv_tell(CsvFile *csv) {
+    CsvPosition position = { -1, csv->current_line_number };
+    if (csv->decoder == NULL && csv->file_ptr != NULL) position.offset = (long long)ftello(csv->file_ptr);
+    return position;
+}
+
+bool csv_seek(CsvFile *csv, const CsvPosition *position) {
+    if (csv->decoder == NULL) {
+        if (csv->file_ptr == NULL || position->offset < 0 ||
+            fseeko(csv->file_ptr, position->offset, SEEK_SET) != 0) {
+            return false;
+        }
+        csv->current_line_number = position->line_number;
+        csv->field_cursor = NULL;
+        return true;
+    }
+
+    // A decoded stream has no offsets: replay it up to the saved line
+    csv_rewind(csv);
+    while (csv->current_line_number < position->line_number) {
+        if (!csv_read_line(csv)) return false;
+    }
+    csv->field_cursor = NULL;
+    return true;
+}
+
+// Called when no more lines can be read: tells the caller's EOF apart from
+// input that ended because it failed
+static void end_of_lines(CsvFile *csv) {
+    csv->field_cursor = NULL;
+
+    if (csv->file_ptr != NULL && ferror(csv->file_ptr) && csv->error[0] == '\0') {
+        snprintf(csv->error, sizeof(csv->error), "Read error after line %lld", csv->current_line_number);
+    }
+#ifdef CSV_HAVE_DECOMPRESSION
+    if (csv->decoder != NULL && csv->file_ptr != NULL) finish_decoder(csv);
+#endif
+}
+
 bool csv_read_line(CsvFile *csv) {
-    if (fgets(csv->line_buffer, MAX_LINE_LENGTH, csv->file_ptr) != NULL) {
-        csv->line_buffer[strcspn(csv->line_buffer, "\n")] = 0; 
+    if (csv->file_ptr != NULL && fgets(csv->line_buffer, MAX_LINE_LENGTH, csv->file_ptr) != NULL) {
+        csv->line_buffer[strcspn(csv->line_buffer, "\r\n")] = 0; 
         csv->current_line_number++;
+        csv->field_cursor = csv->line_buffer;
         return true;
     }
+    end_of_lines(csv);
     return false;
 }
 
+bool csv_read_long_line(CsvFile *csv, char **line, size_t *capacity) {
+    size_t length = 0;
+
+    csv->field_cursor = NULL;
+    if (csv->file_ptr == NULL) return false;
+
+    // fgets in pieces until the newline, doubling the buffer whenever it fills
+    for (;;) {
+        if (*capacity - length < 2) {
+            size_t new_capacity = *capacity ? *capacity * 2 : MAX_LINE_LENGTH;
+            char *grown = (char*)realloc(*line, new_capacity);
+            if (grown == NULL) {
+                snprintf(csv->error, sizeof(csv->error), "Out of memory reading line %lld", csv->current_line_number + 1);
+                return false;
+            }
+            *line = grown;
+            *capacity = new_capacity;
+        }
+        if (fgets(*line + length, (int)(*capacity - length), csv->file_ptr) == NULL) break;
+        length += strlen(*line + length);
+        if ((*line)[length - 1] == '\n') break;
+    }
+
+    if (length == 0) {
+        end_of_lines(csv);
+        return false;
+    }
+    (*line)[strcspn(*line, "\r\n")] = 0;
+    csv->current_line_number++;
+    return true;
+}
+
+const char* csv_error(const CsvFile *csv) {
+    return csv != NULL && csv->error[0] != '\0' ? csv->error : NULL;
+}
+
 char* csv_get_field(CsvFile *csv) {
-    static int last_line_number = -1;
-    
-    // If we're on a new line, reinitialize strtok
-    if (last_line_number != csv->current_line_number) {
-        last_line_number = csv->current_line_number;
-        return strtok(csv->line_buffer, ",");
+    // Tokenizer state lives in the CsvFile itself, so several files can be
+    // parsed at once (strtok keeps a single hidden cursor for the process).
+    char *start = csv->field_cursor;
+    if (start == NULL) return NULL;
+
+    // Every delimiter ends a field, so an empty field keeps its position
+    // instead of shifting the rest of the row one column to the left
+    char *end = strchr(start, ',');
+    if (end != NULL) {
+        *end = '\0';
+        csv->field_cursor = end + 1;
+    } else {
+        csv->field_cursor = NULL;
     }
-    
-    // Continue tokenizing the current line
-    return strtok(NULL, ",");
+    return start;
+}
+
+bool csv_skip_field(CsvFile *csv) {
+    char *start = csv->field_cursor;
+    if (start == NULL) return false;
+
+    // Same field boundaries as csv_get_field, but nothing is terminated or decoded
+    char *end = strchr(start, ',');
+    csv->field_cursor = end != NULL ? end + 1 : NULL;
+    return true;
+}
+
+int csv_map_header(CsvFile *csv) {
+    static const char *column_names[CSV_COLUMN_COUNT] = {
+        "V1_X", "V1_Y", "V1_Z", "V1_MAG",
+        "V2_X", "V2_Y", "V2_Z", "V2_MAG",
+        "V3_X", "V3_Y", "V3_Z", "V3_MAG",
+        "EXPECTED_VOLUME"
+    };
+    CsvColumnMap map;
+    char *field_str;
+    int known = 0;
+
+    if (csv == NULL) return 0;
+
+    for (int c = 0; c < CSV_COLUMN_COUNT; c++) map.field_index[c] = -1;
+    for (int p = 0; p < CSV_MAX_FIELDS; p++) map.position_column[p] = -1;
+
+    for (int position = 0; (field_str = csv_get_field(csv)) != NULL; position++) {
+        if (position >= CSV_MAX_FIELDS) break;
+
+        // Trim surrounding blanks before comparing names
+        while (*field_str == ' ' || *field_str == '\t') field_str++;
+        size_t length = strlen(field_str);
+        while (length > 0 && (field_str[length - 1] == ' ' || field_str[length - 1] == '\t')) length--;
+
+        for (int c = 0; c < CSV_COLUMN_COUNT; c++) {
+            if (map.field_index[c] < 0 && strlen(column_names[c]) == length &&
+                strncasecmp_portable(field_str, column_names[c], length) == 0) {
+                map.field_index[c] = position;
+                map.position_column[position] = (signed char)c;
+                known++;
+                break;
+            }
+        }
+    }
+
+    // Headers without known names keep the positional layout set by csv_open
+    if (known > 0) csv->columns = map;
+    return known;
+}
+
+bool csv_has_columns(const CsvFile *csv, unsigned mask) {
+    for (int c = 0; c < CSV_COLUMN_COUNT; c++) {
+        if ((mask & CSV_MASK(c)) && csv->columns.field_index[c] < 0) return false;
+    }
+    return true;
+}
+
+bool csv_read_test_case(CsvFile *csv, TestCase *test_case) {
+    return csv_read_test_case_columns(csv, test_case, CSV_MASK_ALL);
+}
+
+bool csv_read_test_case_columns(CsvFile *csv, TestCase *test_case, unsigned mask) {
+    double values[CSV_COLUMN_COUNT] = {0};
+    long long int_values[9] = {0};
+    bool integer = (mask & CSV_MASK_VECTORS) == CSV_MASK_VECTORS;
+    int last_position = -1;
+
+    if (!csv || !test_case) return false;
+
+    for (int c = 0; c < CSV_COLUMN_COUNT; c++) {
+        if (!(mask & CSV_MASK(c))) continue;
+        if (csv->columns.field_index[c] < 0) return false;
+        if (csv->columns.field_index[c] > last_position) last_position = csv->columns.field_index[c];
+    }
+
+    // Walk the fields up to the last one needed; everything else is only skipped
+    for (int position = 0; position <= last_position; position++) {
+        int column = csv->columns.position_column[position];
+
+        if (column < 0 || !(mask & CSV_MASK(column))) {
+            if (!csv_skip_field(csv)) return false;
+            continue;
+        }
+
+        // An empty needed field is a malformed row, not a zero
+        char *field_str = csv_get_field(csv);
+        if (field_str == NULL || *field_str == '\0') return false;
+
+        int component = column % 4;
+        if (column != CSV_COL_EXPECTED_VOLUME && component < 3) {
+            if (!parse_coordinate(field_str, &values[column], &int_values[(column / 4) * 3 + component])) {
+                integer = false;
+            }
+        } else {
+            values[column] = atof(field_str);
+        }
+    }
+
+    vector *targets[3] = { &test_case->v1, &test_case->v2, &test_case->v3 };
+    for (int v = 0; v < 3; v++) {
+        for (int i = 0; i < 3; i++) targets[v]->direction[i] = values[4 * v + i];
+        targets[v]->magnitude = values[4 * v + 3];
+    }
+    test_case->expected_volume = values[CSV_COL_EXPECTED_VOLUME];
+    test_case->integer_coordinates = integer;
+    memcpy(test_case->int_coordinates, int_values, sizeof(int_values));
+
+    return true;
 }
 
 void csv_close(CsvFile *csv) {
     if (csv == NULL) return;
+#ifdef CSV_HAVE_DECOMPRESSION
+    if (csv->decoder != NULL) close_decoder(csv); // Also closes file_ptr
+#endif
     if (csv->file_ptr != NULL) {
         fclose(csv->file_ptr);
     }
@@ -85,7 +626,7 @@ void csv_close(CsvFile *csv) {
 
 VectorList csv_read_vector_list(const char *filename) {
     VectorList list = { .vectors = NULL, .count = 0 };
-    CsvFile *file = csv_open(filename);
+    CsvFile *file = csv_open_quiet(filename);
 
     if (file == NULL) return list;
 
@@ -95,7 +636,7 @@ VectorList csv_read_vector_list(const char *filename) {
         vector current_vector;
         
         // Attempt to read the FIRST vector (4 fields)
-        if (read_single_vector(file, &current_vector)) {
+        if (read_single_vector(file, &current_vector, NULL, NULL)) {
             
             // Skip the remaining 9 fields (V2, V3, and EXPECTED_VOLUME)
             for (int i = 0; i < 9; i++) {
@@ -106,20 +647,152 @@ VectorList csv_read_vector_list(const char *filename) {
             vector *new_vectors = realloc(list.vectors, list.count * sizeof(vector));
             
             if (new_vectors == NULL) {
-                fprintf(stderr, "Error: Memory reallocation failed.\n");
                 free_vector_list(&list);
                 csv_close(file);
+                errno = ENOMEM;
                 return (VectorList){ .vectors = NULL, .count = 0 };
             }
             
             list.vectors = new_vectors;
             list.vectors[list.count - 1] = current_vector;
-
-        } else {
-            fprintf(stderr, "Warning: Skipping badly formatted line (could not read V1 data).\n");
         }
+        // Lines without a complete V1 are skipped
     }
 
     csv_close(file);
     return list;
+}
+
+// --- Packed Test Set Implementation ---
+
+PackedTestSet csv_load_packed_test_set(const char *filename) {
+    PackedTestSet set = { NULL, NULL, NULL, NULL, 0, 0 };
+    size_t capacity = 0;
+    CsvFile *file = csv_open_quiet(filename);
+
+    if (file == NULL) return set;
+
+    // The magnitude columns are never decoded
+    unsigned mask = CSV_MASK_VECTORS | CSV_MASK_EXPECTED;
+    if (!csv_read_line(file)) {
+        csv_close(file);
+        return set;
+    }
+    csv_map_header(file);
+    if (!csv_has_columns(file, mask)) {
+        csv_close(file);
+        errno = EINVAL;
+        return set;
+    }
+
+    while (csv_read_line(file)) {
+        TestCase row;
+
+        if (!csv_read_test_case_columns(file, &row, mask)) {
+            set.skipped_rows++;
+            continue;
+        }
+
+        if (set.count == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 1024;
+            PackedVector *n1 = realloc(set.v1, new_capacity * sizeof(PackedVector));
+            if (n1) set.v1 = n1;
+            PackedVector *n2 = realloc(set.v2, new_capacity * sizeof(PackedVector));
+            if (n2) set.v2 = n2;
+            PackedVector *n3 = realloc(set.v3, new_capacity * sizeof(PackedVector));
+            if (n3) set.v3 = n3;
+            double *ne = realloc(set.expected_volume, new_capacity * sizeof(double));
+            if (ne) set.expected_volume = ne;
+
+            if (!n1 || !n2 || !n3 || !ne) {
+                free_packed_test_set(&set);
+                csv_close(file);
+                errno = ENOMEM;
+                return set;
+            }
+            capacity = new_capacity;
+        }
+
+        set.v1[set.count] = packVector(row.v1);
+        set.v2[set.count] = packVector(row.v2);
+        set.v3[set.count] = packVector(row.v3);
+        set.expected_volume[set.count] = row.expected_volume;
+        set.count++;
+    }
+
+    if (csv_error(file) != NULL) {
+        // A partly read set would pass for a smaller file
+        free_packed_test_set(&set);
+        csv_close(file);
+        errno = EIO;
+        return set;
+    }
+    csv_close(file);
+    return set;
+}
+
+void free_packed_test_set(PackedTestSet *set) {
+    if (set == NULL) return;
+    free(set->v1);
+    free(set->v2);
+    free(set->v3);
+    free(set->expected_volume);
+    set->v1 = set->v2 = set->v3 = NULL;
+    set->expected_volume = NULL;
+    set->count = 0;
+}
+
+// --- Numeric Row Loader ---
+
+bool csv_load_numeric_rows(const char *filename, int columns, double **out_values, size_t *out_rows) {
+    double *values = NULL;
+    size_t rows = 0, capacity = 0;
+    CsvFile *file;
+
+    if (out_values == NULL || out_rows == NULL || columns <= 0) return false;
+    *out_values = NULL;
+    *out_rows = 0;
+
+    file = csv_open_quiet(filename);
+    if (file == NULL) return false;
+
+    csv_read_line(file); // Skip header
+
+    while (csv_read_line(file)) {
+        if (rows == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : 1024;
+            double *grown = realloc(values, new_capacity * (size_t)columns * sizeof(double));
+            if (grown == NULL) {
+                free(values);
+                csv_close(file);
+                errno = ENOMEM;
+                return false;
+            }
+            values = grown;
+            capacity = new_capacity;
+        }
+
+        double *row = &values[rows * (size_t)columns];
+        bool complete = true;
+        for (int c = 0; c < columns; c++) {
+            char *field_str = csv_get_field(file);
+            if (field_str == NULL || *field_str == '\0') {
+                complete = false;
+                break;
+            }
+            row[c] = atof(field_str);
+        }
+        if (complete) rows++;
+    }
+
+    if (csv_error(file) != NULL) {
+        free(values);
+        csv_close(file);
+        errno = EIO;
+        return false;
+    }
+    csv_close(file);
+    *out_values = values;
+    *out_rows = rows;
+    return true;
 }
\ No newline at end of file
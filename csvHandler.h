@@ -8,37 +8,198 @@
 #include "mathUtil.h"
 
 #define MAX_LINE_LENGTH 1024
+#define CSV_MAX_FIELDS 64
+#define CSV_ERROR_LENGTH 256
+
+// --- Logical Test Case Columns ---
+typedef enum {
+    CSV_COL_V1_X, CSV_COL_V1_Y, CSV_COL_V1_Z, CSV_COL_V1_MAG,
+    CSV_COL_V2_X, CSV_COL_V2_Y, CSV_COL_V2_Z, CSV_COL_V2_MAG,
+    CSV_COL_V3_X, CSV_COL_V3_Y, CSV_COL_V3_Z, CSV_COL_V3_MAG,
+    CSV_COL_EXPECTED_VOLUME,
+    CSV_COLUMN_COUNT
+} CsvColumn;
+
+// Column masks select which logical columns a row read decodes
+#define CSV_MASK(column)     (1u << (column))
+#define CSV_MASK_V1          (CSV_MASK(CSV_COL_V1_X) | CSV_MASK(CSV_COL_V1_Y) | CSV_MASK(CSV_COL_V1_Z))
+#define CSV_MASK_V2          (CSV_MASK(CSV_COL_V2_X) | CSV_MASK(CSV_COL_V2_Y) | CSV_MASK(CSV_COL_V2_Z))
+#define CSV_MASK_V3          (CSV_MASK(CSV_COL_V3_X) | CSV_MASK(CSV_COL_V3_Y) | CSV_MASK(CSV_COL_V3_Z))
+#define CSV_MASK_VECTORS     (CSV_MASK_V1 | CSV_MASK_V2 | CSV_MASK_V3)
+#define CSV_MASK_MAGNITUDES  (CSV_MASK(CSV_COL_V1_MAG) | CSV_MASK(CSV_COL_V2_MAG) | CSV_MASK(CSV_COL_V3_MAG))
+#define CSV_MASK_EXPECTED    CSV_MASK(CSV_COL_EXPECTED_VOLUME)
+#define CSV_MASK_ALL         (CSV_MASK_VECTORS | CSV_MASK_MAGNITUDES | CSV_MASK_EXPECTED)
+
+// --- Column Mapping (from the header, or positional by default) ---
+typedef struct {
+    int field_index[CSV_COLUMN_COUNT];       // Field position of each column, -1 if absent
+    signed char position_column[CSV_MAX_FIELDS]; // Column at each field position, -1 if unused
+} CsvColumnMap;
+
+// Background decompressor feeding file_ptr for gzip/zstd inputs (opaque)
+typedef struct CsvDecoder CsvDecoder;
 
 // --- CSV File Structure ---
 typedef struct {
-    FILE *file_ptr;
+    FILE *file_ptr;     // The file itself, or the read end of the decoder's pipe
+    CsvDecoder *decoder; // NULL for uncompressed files
     char line_buffer[MAX_LINE_LENGTH];
-    int current_line_number;
+    long long current_line_number;
+    char *field_cursor; // Tokenizer position inside line_buffer (NULL when exhausted)
+    CsvColumnMap columns;
+    char error[CSV_ERROR_LENGTH]; // Why reading stopped early (empty when it did not)
 } CsvFile;
 
+// --- Saved Read Position (see csv_tell / csv_seek) ---
+typedef struct {
+    long long offset; // Byte offset of the next line, -1 for compressed input
+    long long line_number; // Lines read so far (the header is line 1)
+} CsvPosition;
+
+// --- Test Case Row Structure (up to 13 fields) ---
+typedef struct {
+    vector v1;
+    vector v2;
+    vector v3;
+    double expected_volume;
+    bool integer_coordinates;     // All 9 coordinates are integers within EXACT_COORD_LIMIT
+    long long int_coordinates[9]; // V1, V2, V3 components (valid when integer_coordinates)
+} TestCase;
+
+// --- Packed Test Set (whole file, no magnitude columns) ---
+typedef struct {
+    PackedVector *v1;        // count entries each
+    PackedVector *v2;
+    PackedVector *v3;
+    double *expected_volume;
+    size_t count;            // Rows loaded
+    size_t skipped_rows;     // Rows with missing fields
+} PackedTestSet;
+
 // --- Core CSV Function Prototypes ---
 
 /**
- * @brief Opens a CSV file for reading
+ * @brief Opens a CSV file for reading and prints the reason on failure (for the
+ * command line; library code uses csv_open_quiet)
  * @param filename Path to the CSV file
  * @return Pointer to CsvFile structure, or NULL on failure
  */
 CsvFile* csv_open(const char *filename);
 
+/**
+ * @brief Opens a CSV file for reading without printing anything on failure.
+ * gzip and zstd files are detected by their magic bytes and decompressed on a
+ * background thread while the file is parsed (builds with -DCSV_HAVE_ZLIB -lz
+ * and/or -DCSV_HAVE_ZSTD -lzstd; otherwise they fail with errno ENOTSUP)
+ * @param filename Path to the CSV file
+ * @return Pointer to CsvFile structure, or NULL on failure (errno is preserved)
+ */
+CsvFile* csv_open_quiet(const char *filename);
+
+/**
+ * @brief Rewinds the CSV file to its first line (the header).
+ * Compressed files restart decoding from the beginning.
+ * @param csv Pointer to CsvFile structure
+ */
+void csv_rewind(CsvFile *csv);
+
+/**
+ * @brief Records where the next csv_read_line will continue
+ * @param csv Pointer to CsvFile structure
+ * @return Current position (offset -1 when the input is decompressed on the fly)
+ */
+CsvPosition csv_tell(CsvFile *csv);
+
+/**
+ * @brief Continues reading from a position returned by csv_tell.
+ * Plain files seek straight to the offset; compressed files are decoded again
+ * from the start and skip the lines already read.
+ * @param csv Pointer to CsvFile structure
+ * @param position Saved position
+ * @return true if the position was reached, false on I/O error or early EOF
+ */
+bool csv_seek(CsvFile *csv, const CsvPosition *position);
+
 /**
  * @brief Reads the next line from the CSV file
  * @param csv Pointer to CsvFile structure
- * @return true if successful, false on EOF or error
+ * @return true if successful, false on EOF or error (see csv_error)
  */
 bool csv_read_line(CsvFile *csv);
 
 /**
- * @brief Retrieves the next field from the current line
+ * @brief Reads the next line whole into a caller-owned buffer. Unlike
+ * csv_read_line, lines longer than MAX_LINE_LENGTH are not split; the field
+ * tokenizer (csv_get_field) is left without a line.
+ * @param csv Pointer to CsvFile structure
+ * @param line Buffer, grown with realloc as needed (may start as NULL; the caller frees it)
+ * @param capacity Size of *line in bytes (0 when *line is NULL)
+ * @return true if a line was read, false on EOF or error (see csv_error)
+ */
+bool csv_read_long_line(CsvFile *csv, char **line, size_t *capacity);
+
+/**
+ * @brief Tells a read error apart from the end of the file. A corrupt or
+ * truncated compressed file, or a failed read, ends the lines early like EOF;
+ * the reason is kept until the file is rewound.
  * @param csv Pointer to CsvFile structure
- * @return Pointer to field string, or NULL if no more fields
+ * @return Description of the error, or NULL if every line so far was read cleanly
+ */
+const char* csv_error(const CsvFile *csv);
+
+/**
+ * @brief Retrieves the next field from the current line. Every comma ends a
+ * field, so consecutive delimiters yield empty strings.
+ * @param csv Pointer to CsvFile structure
+ * @return Pointer to field string (possibly empty), or NULL if no more fields
  */
 char* csv_get_field(CsvFile *csv);
 
+/**
+ * @brief Skips the next field of the current line without decoding it
+ * @param csv Pointer to CsvFile structure
+ * @return true if a field was skipped, false if the line has no more fields
+ */
+bool csv_skip_field(CsvFile *csv);
+
+/**
+ * @brief Builds the column mapping from the current line (the header).
+ * Known names (V1_X ... V3_MAG, EXPECTED_VOLUME, any case) may appear in any
+ * order among other columns. A header without any known name keeps the
+ * positional 13-column layout.
+ * @param csv Pointer to CsvFile structure (the header line must have been read)
+ * @return Number of known columns found in the header (0 = positional layout)
+ */
+int csv_map_header(CsvFile *csv);
+
+/**
+ * @brief Checks that every column of a mask is present in the column mapping
+ * @param csv Pointer to CsvFile structure
+ * @param mask Column mask (CSV_MASK_*)
+ * @return true if all requested columns can be read
+ */
+bool csv_has_columns(const CsvFile *csv, unsigned mask);
+
+/**
+ * @brief Parses the 13 fields of the current line into a test case
+ * @param csv Pointer to CsvFile structure (a line must have been read)
+ * @param test_case Output test case
+ * @return true if all 13 fields were present, false otherwise
+ */
+bool csv_read_test_case(CsvFile *csv, TestCase *test_case);
+
+/**
+ * @brief Parses only the masked columns of the current line into a test case.
+ * Unneeded fields are stepped over without decoding, and the line is not
+ * scanned past the last needed field. Unread values are left at zero and
+ * integer_coordinates is only set when all nine coordinates were read.
+ * @param csv Pointer to CsvFile structure (a line must have been read)
+ * @param test_case Output test case
+ * @param mask Column mask (CSV_MASK_*)
+ * @return true if every masked field was present, false otherwise
+ */
+bool csv_read_test_case_columns(CsvFile *csv, TestCase *test_case, unsigned mask);
+
 /**
  * @brief Closes the CSV file and frees memory
  * @param csv Pointer to CsvFile structure
@@ -48,8 +209,34 @@ void csv_close(CsvFile *csv);
 /**
  * @brief Reads a list of vectors from CSV file (legacy function)
  * @param filename Path to the CSV file
- * @return VectorList structure with vectors
+ * @return VectorList structure with vectors (empty on failure, errno tells why)
  */
 VectorList csv_read_vector_list(const char *filename);
 
+/**
+ * @brief Loads every test case of a CSV file into compact vectors.
+ * The V*_MAG columns are skipped without being decoded.
+ * @param filename Path to the CSV file (with header)
+ * @return PackedTestSet (count 0 and NULL arrays on failure; errno is EINVAL
+ *         for missing columns, EIO for a read error, ENOMEM, or from fopen)
+ */
+PackedTestSet csv_load_packed_test_set(const char *filename);
+
+/**
+ * @brief Loads the first `columns` numeric fields of every row (header skipped)
+ * Used for files that are not test cases, e.g. point clouds (X,Y,Z) or shapes.
+ * @param filename Path to the CSV file (with header)
+ * @param columns Number of leading fields to read per row
+ * @param out_values Receives a malloc'd row-major array of rows * columns doubles
+ * @param out_rows Receives the number of rows loaded (rows with missing fields are skipped)
+ * @return true on success, false on I/O or memory failure (errno tells why; nothing is printed)
+ */
+bool csv_load_numeric_rows(const char *filename, int columns, double **out_values, size_t *out_rows);
+
+/**
+ * @brief Frees the arrays of a PackedTestSet
+ * @param set Set to clean up
+ */
+void free_packed_test_set(PackedTestSet *set);
+
 #endif // CSV_HANDLER_H
\ No newline at end of file
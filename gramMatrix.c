@@ -0,0 +1,321 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "gramMatrix.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define ROW_BLOCK 64          // Rows of a block sharing one column block
+#define COL_BLOCK 512         // Column vectors kept in L1 (3 * 512 doubles)
+#define DEFAULT_TILE_SIZE 1024
+
+// --- Data Structures ---
+
+// Structure-of-arrays copy of the input: unit-stride loads for the SIMD loop
+typedef struct {
+    double *x, *y, *z;
+    double *inv_norm; // 1 / |v|, 0 for zero vectors
+    size_t count;
+} GramInput;
+
+// Pair with its ranking score (cosine, or |cosine| for absolute ranking)
+typedef struct {
+    AlignedPair pair;
+    double score;
+} ScoredPair;
+
+// Min-heap of the best pairs found by one thread (root = worst kept pair)
+typedef struct {
+    ScoredPair *items;
+    size_t count, capacity;
+} PairHeap;
+
+// --- Helper Prototypes ---
+static bool prepare_input(const PackedVector *vectors, size_t count, GramInput *input);
+static void free_input(GramInput *input);
+static void compute_block(const GramInput *input, GramValue value, size_t row_start, size_t rows,
+                          size_t col_start, size_t cols, double *out, size_t stride);
+static int thread_count(void);
+static bool better_pair(const ScoredPair *a, const ScoredPair *b);
+static void heap_offer(PairHeap *heap, const ScoredPair *item);
+static int compare_pairs(const void *lhs, const void *rhs);
+
+static bool prepare_input(const PackedVector *vectors, size_t count, GramInput *input) {
+    size_t n = count ? count : 1;
+
+    input->count = count;
+    input->x = (double*)malloc(n * sizeof(double));
+    input->y = (double*)malloc(n * sizeof(double));
+    input->z = (double*)malloc(n * sizeof(double));
+    input->inv_norm = (double*)malloc(n * sizeof(double));
+    if (!input->x || !input->y || !input->z || !input->inv_norm) {
+        free_input(input);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        double magnitude = packedMagnitude(vectors[i]);
+        input->x[i] = vectors[i].direction[0];
+        input->y[i] = vectors[i].direction[1];
+        input->z[i] = vectors[i].direction[2];
+        input->inv_norm[i] = magnitude > 0.0 ? 1.0 / magnitude : 0.0;
+    }
+    return true;
+}
+
+static void free_input(GramInput *input) {
+    free(input->x);
+    free(input->y);
+    free(input->z);
+    free(input->inv_norm);
+    memset(input, 0, sizeof(*input));
+}
+
+// out[r * stride + c] = G[row_start + r][col_start + c], walking COL_BLOCK columns at a time
+static void compute_block(const GramInput *input, GramValue value, size_t row_start, size_t rows,
+                          size_t col_start, size_t cols, double *out, size_t stride) {
+    for (size_t c0 = 0; c0 < cols; c0 += COL_BLOCK) {
+        size_t width = cols - c0 < COL_BLOCK ? cols - c0 : COL_BLOCK;
+        const double *xj = &input->x[col_start + c0];
+        const double *yj = &input->y[col_start + c0];
+        const double *zj = &input->z[col_start + c0];
+        const double *nj = &input->inv_norm[col_start + c0];
+
+        for (size_t r = 0; r < rows; r++) {
+            size_t i = row_start + r;
+            double xi = input->x[i], yi = input->y[i], zi = input->z[i];
+            double *row = &out[r * stride + c0];
+
+            if (value == GRAM_COSINE) {
+                double ni = input->inv_norm[i];
+                #pragma omp simd
+                for (size_t c = 0; c < width; c++) row[c] = (xi * xj[c] + yi * yj[c] + zi * zj[c]) * ni * nj[c];
+            } else {
+                #pragma omp simd
+                for (size_t c = 0; c < width; c++) row[c] = xi * xj[c] + yi * yj[c] + zi * zj[c];
+            }
+        }
+    }
+}
+
+static int thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// --- Full Matrix ---
+
+bool gram_matrix(const PackedVector *vectors, size_t count, GramValue value, double *out) {
+    GramInput input;
+
+    if ((vectors == NULL || out == NULL) && count > 0) return false;
+    if (!prepare_input(vectors, count, &input)) return false;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long long block = 0; block < (long long)((count + ROW_BLOCK - 1) / ROW_BLOCK); block++) {
+        size_t row_start = (size_t)block * ROW_BLOCK;
+        size_t rows = count - row_start < ROW_BLOCK ? count - row_start : ROW_BLOCK;
+        compute_block(&input, value, row_start, rows, 0, count, &out[row_start * count], count);
+    }
+
+    free_input(&input);
+    return true;
+}
+
+// --- Streaming Tiles ---
+
+bool gram_matrix_tiles(const PackedVector *vectors, size_t count, GramValue value, size_t tile_size,
+                       bool upper_only, GramTileCallback callback, void *user_data) {
+    GramInput input;
+    size_t tiles_per_side, tile_total, group;
+    double *buffers;
+    GramTile *tiles;
+    bool ok = true;
+
+    if (callback == NULL || (vectors == NULL && count > 0)) return false;
+    if (tile_size == 0) tile_size = DEFAULT_TILE_SIZE;
+    if (count == 0) return true;
+    if (tile_size > count) tile_size = count; // A larger tile only wastes buffer space
+
+    tiles_per_side = (count + tile_size - 1) / tile_size;
+    tile_total = upper_only ? tiles_per_side * (tiles_per_side + 1) / 2 : tiles_per_side * tiles_per_side;
+    group = (size_t)thread_count();
+    if (group > tile_total) group = tile_total;
+
+    // One tile_size^2 buffer per thread; refuse sizes whose byte count wraps
+    if (tile_size > SIZE_MAX / sizeof(double) / group / tile_size) return false;
+
+    if (!prepare_input(vectors, count, &input)) return false;
+    buffers = (double*)malloc(group * tile_size * tile_size * sizeof(double));
+    tiles = (GramTile*)malloc(group * sizeof(GramTile));
+    if (buffers == NULL || tiles == NULL) {
+        free(buffers);
+        free(tiles);
+        free_input(&input);
+        return false;
+    }
+
+    // Each round computes one tile per thread, then hands them over in order
+    size_t tile_row = 0, tile_col = 0;
+    for (size_t first = 0; ok && first < tile_total; first += group) {
+        size_t batch = tile_total - first < group ? tile_total - first : group;
+
+        for (size_t t = 0; t < batch; t++) {
+            tiles[t].row_start = tile_row * tile_size;
+            tiles[t].col_start = tile_col * tile_size;
+            tiles[t].rows = count - tiles[t].row_start < tile_size ? count - tiles[t].row_start : tile_size;
+            tiles[t].cols = count - tiles[t].col_start < tile_size ? count - tiles[t].col_start : tile_size;
+            tiles[t].values = &buffers[t * tile_size * tile_size];
+
+            if (++tile_col == tiles_per_side) {
+                tile_row++;
+                tile_col = upper_only ? tile_row : 0;
+            }
+        }
+
+        #pragma omp parallel for schedule(static, 1)
+        for (long long t = 0; t < (long long)batch; t++) {
+            compute_block(&input, value, tiles[t].row_start, tiles[t].rows, tiles[t].col_start,
+                          tiles[t].cols, &buffers[(size_t)t * tile_size * tile_size], tiles[t].cols);
+        }
+
+        for (size_t t = 0; ok && t < batch; t++) ok = callback(&tiles[t], user_data);
+    }
+
+    free(buffers);
+    free(tiles);
+    free_input(&input);
+    return ok;
+}
+
+// --- Top-k Aligned Pairs ---
+
+// Total order: higher score first, then lower (i, j)
+static bool better_pair(const ScoredPair *a, const ScoredPair *b) {
+    if (a->score != b->score) return a->score > b->score;
+    if (a->pair.i != b->pair.i) return a->pair.i < b->pair.i;
+    return a->pair.j < b->pair.j;
+}
+
+static void heap_offer(PairHeap *heap, const ScoredPair *item) {
+    size_t node;
+
+    if (heap->count < heap->capacity) {
+        // Sift up from the new leaf
+        node = heap->count++;
+        while (node > 0) {
+            size_t parent = (node - 1) / 2;
+            if (!better_pair(&heap->items[parent], item)) break;
+            heap->items[node] = heap->items[parent];
+            node = parent;
+        }
+    } else {
+        if (!better_pair(item, &heap->items[0])) return;
+        // Replace the root and sift down
+        node = 0;
+        for (;;) {
+            size_t child = 2 * node + 1;
+            if (child >= heap->count) break;
+            if (child + 1 < heap->count && better_pair(&heap->items[child], &heap->items[child + 1])) child++;
+            if (!better_pair(item, &heap->items[child])) break;
+            heap->items[node] = heap->items[child];
+            node = child;
+        }
+    }
+    heap->items[node] = *item;
+}
+
+static int compare_pairs(const void *lhs, const void *rhs) {
+    const ScoredPair *a = (const ScoredPair*)lhs, *b = (const ScoredPair*)rhs;
+    if (better_pair(a, b)) return -1;
+    return better_pair(b, a) ? 1 : 0;
+}
+
+bool gram_top_aligned(const PackedVector *vectors, size_t count, size_t k, bool absolute,
+                      AlignedPair *out, size_t *found) {
+    GramInput input;
+    int threads = thread_count();
+    ScoredPair *all;
+    size_t all_count = 0;
+    bool failed = false;
+
+    if (found == NULL || (k > 0 && out == NULL) || (vectors == NULL && count > 0) || count > UINT32_MAX) return false;
+    *found = 0;
+    if (k == 0 || count < 2) return true;
+
+    // No more than every pair can be found; each thread keeps a heap of k
+    size_t pair_total = count % 2 == 0 ? count / 2 * (count - 1) : (count - 1) / 2 * count;
+    if (k > pair_total) k = pair_total;
+    if (k > SIZE_MAX / sizeof(ScoredPair) / (size_t)threads) return false;
+    if (!prepare_input(vectors, count, &input)) return false;
+
+    all = (ScoredPair*)malloc((size_t)threads * k * sizeof(ScoredPair));
+    if (all == NULL) {
+        free_input(&input);
+        return false;
+    }
+
+    #pragma omp parallel
+    {
+        PairHeap heap = { (ScoredPair*)malloc(k * sizeof(ScoredPair)), 0, k };
+        double *tile = (double*)malloc(ROW_BLOCK * COL_BLOCK * sizeof(double));
+        bool local_failed = tile == NULL || heap.items == NULL;
+
+        // Upper triangle only: row block b pairs with columns from its own first row on
+        #pragma omp for schedule(dynamic)
+        for (long long block = 0; block < (long long)((count + ROW_BLOCK - 1) / ROW_BLOCK); block++) {
+            size_t row_start = (size_t)block * ROW_BLOCK;
+            size_t rows = count - row_start < ROW_BLOCK ? count - row_start : ROW_BLOCK;
+            if (local_failed) continue;
+
+            for (size_t col_start = row_start; col_start < count; col_start += COL_BLOCK) {
+                size_t cols = count - col_start < COL_BLOCK ? count - col_start : COL_BLOCK;
+                compute_block(&input, GRAM_COSINE, row_start, rows, col_start, cols, tile, cols);
+
+                for (size_t r = 0; r < rows; r++) {
+                    size_t i = row_start + r;
+                    if (input.inv_norm[i] == 0.0) continue;
+                    size_t c = i + 1 > col_start ? i + 1 - col_start : 0;
+                    for (; c < cols; c++) {
+                        size_t j = col_start + c;
+                        double cosine = tile[r * cols + c];
+                        double score = absolute ? fabs(cosine) : cosine;
+                        if (input.inv_norm[j] == 0.0) continue;
+                        if (heap.count == heap.capacity && score < heap.items[0].score) continue; // Fast reject
+
+                        ScoredPair item = { { (uint32_t)i, (uint32_t)j, cosine }, score };
+                        heap_offer(&heap, &item);
+                    }
+                }
+            }
+        }
+
+        #pragma omp critical(gram_top_merge)
+        {
+            if (local_failed) {
+                failed = true;
+            } else {
+                memcpy(&all[all_count], heap.items, heap.count * sizeof(ScoredPair));
+                all_count += heap.count;
+            }
+        }
+        free(tile);
+        free(heap.items);
+    }
+
+    if (!failed) {
+        qsort(all, all_count, sizeof(ScoredPair), compare_pairs);
+        *found = all_count < k ? all_count : k;
+        for (size_t p = 0; p < *found; p++) out[p] = all[p].pair;
+    }
+
+    free(all);
+    free_input(&input);
+    return !failed;
+}
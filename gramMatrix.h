@@ -0,0 +1,74 @@
+#ifndef GRAM_MATRIX_H
+#define GRAM_MATRIX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "mathUtil.h"
+
+// --- Data Structures ---
+
+typedef enum {
+    GRAM_DOT,    // G[i][j] = vi · vj (as scalaricProduct)
+    GRAM_COSINE  // G[i][j] = vi · vj / (|vi| |vj|), 0 when either vector is zero
+} GramValue;
+
+// One block of the matrix handed to a tile callback
+typedef struct {
+    size_t row_start, col_start; // Position of values[0] in the full matrix
+    size_t rows, cols;
+    const double *values;        // rows x cols, row-major (valid during the callback only)
+} GramTile;
+
+// Receives the tiles in row-major tile order; return false to stop early
+typedef bool (*GramTileCallback)(const GramTile *tile, void *user_data);
+
+// A pair of distinct vectors (i < j) and their cosine
+typedef struct {
+    uint32_t i, j;
+    double cosine;
+} AlignedPair;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Computes the full N x N Gram matrix (cache-blocked, SIMD, multithreaded)
+ * @param vectors Input vectors
+ * @param count Number of vectors (N)
+ * @param value Dot products or cosines
+ * @param out Receives N * N doubles, row-major
+ * @return true on success, false on allocation failure
+ */
+bool gram_matrix(const PackedVector *vectors, size_t count, GramValue value, double *out);
+
+/**
+ * @brief Streams the Gram matrix tile by tile, for matrices that do not fit in memory.
+ * Tiles are computed in parallel and delivered in order from the calling thread.
+ * @param vectors Input vectors
+ * @param count Number of vectors (N)
+ * @param value Dot products or cosines
+ * @param tile_size Tile edge (0 = default, larger than count = count)
+ * @param upper_only Only tiles on or above the diagonal (the matrix is symmetric)
+ * @param callback Called once per tile
+ * @param user_data Passed to the callback
+ * @return true if every tile was delivered, false on allocation failure (or a tile
+ *         buffer too large to address) or when the callback stopped
+ */
+bool gram_matrix_tiles(const PackedVector *vectors, size_t count, GramValue value, size_t tile_size,
+                       bool upper_only, GramTileCallback callback, void *user_data);
+
+/**
+ * @brief Finds the k most aligned pairs (largest cosine, or |cosine| when absolute)
+ * Zero vectors are ignored. Ties are broken by index, so results do not depend on threading.
+ * @param vectors Input vectors (at most UINT32_MAX)
+ * @param count Number of vectors
+ * @param k Pairs to return (more than N*(N-1)/2 is clamped)
+ * @param absolute Rank anti-parallel pairs like parallel ones
+ * @param out Receives up to k pairs, most aligned first
+ * @param found Receives the number of pairs written
+ * @return true on success, false on allocation failure
+ */
+bool gram_top_aligned(const PackedVector *vectors, size_t count, size_t k, bool absolute,
+                      AlignedPair *out, size_t *found);
+
+#endif // GRAM_MATRIX_H
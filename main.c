@@ -5,6 +5,7 @@
 #include "mathUtil.h"
 #include "csvHandler.h"
 #include "testerFile.h"
+#include "commandLine.h"
 
 // --- Forward Declarations ---
 void display_main_menu(void);
@@ -18,10 +19,15 @@ void vector_operation(void);
 void volume_calculation(void);
 
 // --- Main Function ---
-int main() {
+int main(int argc, char *argv[]) {
     int choice;
     bool running = true;
 
+    // Any argument selects the headless command line mode
+    if (argc > 1) {
+        return run_command_line(argc, argv);
+    }
+
     while (running) {
         clear_screen();
         display_main_menu();
@@ -166,22 +172,22 @@ void run_tester_module(void) {
     printf("\n");
     switch(test_choice) {
         case 1:
-            run_volume_tests(csv, volumeParallelepiped, "Parallelepiped Volume", 1.0);
+            run_volume_tests(csv, volumeParallelepiped, "Parallelepiped Volume", 1.0, NULL);
             break;
         case 2:
-            run_volume_tests(csv, volumeParallelepiped, "Pyramid Volume", 6.0);
+            run_volume_tests(csv, volumeParallelepiped, "Pyramid Volume", 6.0, NULL);
             break;
         case 3:
-            run_cross_product_tests(csv, crossProduct);
+            run_cross_product_tests(csv, crossProduct, NULL);
             break;
         case 4:
-            run_scalar_product_tests(csv, scalaricProduct);
+            run_scalar_product_tests(csv, scalaricProduct, NULL);
             break;
         case 5:
-            run_volume_tests(csv, volumeParallelepiped, "Parallelepiped Volume", 1.0);
-            run_volume_tests(csv, volumeParallelepiped, "Pyramid Volume", 6.0);
-            run_cross_product_tests(csv, crossProduct);
-            run_scalar_product_tests(csv, scalaricProduct);
+            run_volume_tests(csv, volumeParallelepiped, "Parallelepiped Volume", 1.0, NULL);
+            run_volume_tests(csv, volumeParallelepiped, "Pyramid Volume", 6.0, NULL);
+            run_cross_product_tests(csv, crossProduct, NULL);
+            run_scalar_product_tests(csv, scalaricProduct, NULL);
             break;
         default:
             printf("Invalid choice.\n");
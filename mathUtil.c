@@ -34,6 +34,96 @@ double volumeParallelepiped(vector vectors[],double k){
     return fabs(scalar_triple_product)/k;
 }
 
+exact_int tripleProductExact(const long long coords[9]){
+    const long long *v1 = &coords[0], *v2 = &coords[3], *v3 = &coords[6];
+
+    // Same determinant expansion as crossProduct, in exact integer arithmetic
+    exact_int cx = (exact_int)v1[1] * v2[2] - (exact_int)v2[1] * v1[2];
+    exact_int cy = (exact_int)v1[2] * v2[0] - (exact_int)v1[0] * v2[2];
+    exact_int cz = (exact_int)v1[0] * v2[1] - (exact_int)v2[0] * v1[1];
+
+    return cx * v3[0] + cy * v3[1] + cz * v3[2];
+}
+
+double volumeParallelepipedExact(const long long coords[9], double k){
+    exact_int triple = tripleProductExact(coords);
+    if (triple < 0) triple = -triple;
+
+    // Single rounding: the integer result is converted to double only here
+    return (double)triple / k;
+}
+
+double matrixDeterminant(const double matrix[9]){
+    vector rows[3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) rows[i].direction[j] = matrix[3 * i + j];
+        rows[i].magnitude = 0.0;
+    }
+
+    // Same triple product as volumeParallelepiped, keeping the sign
+    return scalaricProduct(crossProduct(rows[0], rows[1]), rows[2]);
+}
+
+bool pointInParallelepiped(vector shape[], vector point, double tolerance){
+    // Signed volume of the shape, every coefficient shares it as denominator
+    vector bc = crossProduct(shape[1], shape[2]);
+    double det = scalaricProduct(shape[0], bc);
+
+    if (fabs(det) < 1e-12) return false;
+
+    vector ca = crossProduct(shape[2], shape[0]);
+    vector ab = crossProduct(shape[0], shape[1]);
+    double coefficients[3] = {
+        scalaricProduct(point, bc) / det,
+        scalaricProduct(point, ca) / det,
+        scalaricProduct(point, ab) / det
+    };
+
+    for (int i = 0; i < 3; i++) {
+        if (coefficients[i] < -tolerance || coefficients[i] > 1.0 + tolerance) return false;
+    }
+    return true;
+}
+
+PackedVector packVector(vector v){
+    PackedVector p = {{ v.direction[0], v.direction[1], v.direction[2] }};
+    return p;
+}
+
+PackedVectorF packVectorF(vector v){
+    PackedVectorF p = {{ (float)v.direction[0], (float)v.direction[1], (float)v.direction[2] }};
+    return p;
+}
+
+vector unpackVector(PackedVector p){
+    vector v;
+    for (int i = 0; i < 3; i++) v.direction[i] = p.direction[i];
+    v.magnitude = packedMagnitude(p);
+    return v;
+}
+
+vector unpackVectorF(PackedVectorF p){
+    PackedVector wide = {{ p.direction[0], p.direction[1], p.direction[2] }};
+    return unpackVector(wide);
+}
+
+double packedMagnitude(PackedVector p){
+    return sqrt(p.direction[0] * p.direction[0] +
+                p.direction[1] * p.direction[1] +
+                p.direction[2] * p.direction[2]);
+}
+
+double volumeParallelepipedPacked(const PackedVector vectors[], double k){
+    const double *a = vectors[0].direction, *b = vectors[1].direction, *c = vectors[2].direction;
+
+    // (a x b) · c without building intermediate vectors or magnitudes
+    double x = (a[1] * b[2]) - (b[1] * a[2]);
+    double y = (a[2] * b[0]) - (a[0] * b[2]);
+    double z = (a[0] * b[1]) - (b[0] * a[1]);
+
+    return fabs(x * c[0] + y * c[1] + z * c[2])/k;
+}
+
 void free_vector_list(VectorList *list) {
     if (list != NULL && list->vectors != NULL) {
         free(list->vectors);
@@ -7,6 +7,16 @@
 #include <stdbool.h>
 
 #define PI 3.1415
+
+// Exact integer arithmetic for the triple product. With a 128-bit type every
+// coordinate up to 2^40 keeps (V1 x V2) · V3 exact; plain 64-bit allows 2^20.
+#ifdef __SIZEOF_INT128__
+typedef __int128 exact_int;
+#define EXACT_COORD_LIMIT (1LL << 40)
+#else
+typedef long long exact_int;
+#define EXACT_COORD_LIMIT (1LL << 20)
+#endif
 // --- Data Structures ---
 
 typedef struct {
@@ -14,6 +24,17 @@ typedef struct {
     double magnitude;
 } vector;
 
+// Compact vectors for memory-bound batch work: the magnitude is not stored
+// but computed on demand. An array of PackedVector has the same layout as the
+// interleaved x,y,z arrays taken by the libvecvol batch calls.
+typedef struct {
+    double direction[3]; // 24 bytes
+} PackedVector;
+
+typedef struct {
+    float direction[3];  // 12 bytes, ~7 significant digits
+} PackedVectorF;
+
 typedef struct {
     vector *vectors; // Dynamic array of vectors
     size_t count;    // Number of vectors in the array
@@ -46,6 +67,83 @@ vector crossProduct(vector v1, vector v2);
  */
 double volumeParallelepiped(vector vectors[], double k);
 
+/**
+ * @brief exact scalar triple product (V1 x V2) · V3 of integer coordinates.
+ * @param coords V1, V2, V3 components (9 values, each within EXACT_COORD_LIMIT)
+ * @return signed triple product, exact
+ */
+exact_int tripleProductExact(const long long coords[9]);
+
+/**
+ * @brief volume of a parallelepiped from integer coordinates (exact up to the final division).
+ * @param coords V1, V2, V3 components (9 values, each within EXACT_COORD_LIMIT)
+ * @param k is the constant for the shape
+ * @return volume
+ */
+double volumeParallelepipedExact(const long long coords[9], double k);
+
+/**
+ * @brief determinant of a 3x3 matrix: the signed volume spanned by its rows.
+ * A linear map with this matrix scales every volume by |determinant|.
+ * @param matrix row-major 3x3 matrix (9 values)
+ * @return determinant
+ */
+double matrixDeterminant(const double matrix[9]);
+
+/**
+ * @brief check whether a point lies inside the parallelepiped spanned by 3 edge vectors.
+ * The point is written as a*V1 + b*V2 + c*V3 (Cramer's rule) and is inside when
+ * every coefficient is in [0, 1] (widened by the tolerance).
+ * @param shape[] the three edge vectors of the parallelepiped (from the origin)
+ * @param point the point to check
+ * @param tolerance slack allowed on each coefficient
+ * @return true if inside, false if outside or the shape is flat (volume ~0)
+ */
+bool pointInParallelepiped(vector shape[], vector point, double tolerance);
+
+/**
+ * @brief convert a vector to its compact form (drops the stored magnitude).
+ * @param v vector to convert
+ * @return packed vector
+ */
+PackedVector packVector(vector v);
+
+/**
+ * @brief convert a vector to its compact single precision form.
+ * @param v vector to convert
+ * @return packed float vector (components rounded to float)
+ */
+PackedVectorF packVectorF(vector v);
+
+/**
+ * @brief expand a compact vector, computing its magnitude.
+ * @param p packed vector
+ * @return full vector
+ */
+vector unpackVector(PackedVector p);
+
+/**
+ * @brief expand a compact single precision vector, computing its magnitude.
+ * @param p packed float vector
+ * @return full vector
+ */
+vector unpackVectorF(PackedVectorF p);
+
+/**
+ * @brief magnitude of a compact vector, computed on demand.
+ * @param p packed vector
+ * @return magnitude
+ */
+double packedMagnitude(PackedVector p);
+
+/**
+ * @brief volume of a parallelepiped from compact vectors (same math as volumeParallelepiped).
+ * @param vectors[] the three direction vectors of the parallelepiped
+ * @param k is the constant for the shape
+ * @return volume
+ */
+double volumeParallelepipedPacked(const PackedVector vectors[], double k);
+
 /**
  * @brief Frees the dynamically allocated memory used by the VectorList.
  * @param list The VectorList to clean up.
@@ -0,0 +1,597 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include "queryEngine.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define QUERY_BLOCK_ROWS 4096 // Rows parsed before a parallel filtering pass
+#define QUERY_NAME_LENGTH 32
+
+// Evaluation cost of a column; conditions run cheapest first
+typedef enum {
+    COST_ROW,      // Known before the row is parsed
+    COST_INPUT,    // Decoded field
+    COST_PRODUCT,  // One dot or cross product
+    COST_VOLUME    // Triple product (and norms)
+} ColumnCost;
+
+// Block row states
+enum { ROW_SKIPPED, ROW_PARSED, ROW_MATCHED };
+
+// --- Data Structures ---
+
+// Query with its conditions in evaluation order and the derived scan plan
+typedef struct {
+    const Query *query;
+    QueryCondition conditions[QUERY_MAX_CONDITIONS]; // Sorted by cost
+    int condition_count;
+    int row_conditions;                   // Leading conditions on ROW only
+    QueryColumn outputs[QUERY_COLUMN_COUNT]; // Printed after the row number
+    int output_count;
+    unsigned mask;                        // CSV columns to decode
+} QueryPlan;
+
+// Lazily computed columns of one row
+typedef struct {
+    const TestCase *test;
+    long long row;
+    double k_value;
+    uint32_t known; // Bit per column already in values
+    double values[QUERY_COLUMN_COUNT];
+} RowValues;
+
+// Selected row: its number and the printed columns
+typedef struct {
+    long long row;
+    double values[QUERY_COLUMN_COUNT]; // Indexed by column (only outputs are set)
+} QueryRow;
+
+// Heap of the best rows found by one thread (root = worst kept row)
+typedef struct {
+    QueryRow *items;
+    size_t count, capacity;
+} RowHeap;
+
+// --- Helper Prototypes ---
+static bool names_equal(const char *a, const char *b);
+static const char *skip_spaces(const char *cursor);
+static bool parse_operator(const char **cursor, QueryOperator *op);
+static ColumnCost column_cost(QueryColumn column);
+static unsigned column_mask(QueryColumn column);
+static void plan_query(const Query *query, QueryPlan *plan);
+static double column_value(RowValues *row, QueryColumn column);
+static bool compare(double value, QueryOperator op, double operand);
+static bool past_row_bound(const QueryCondition *condition, long long row);
+static bool row_matches(const QueryPlan *plan, RowValues *row);
+static bool better_row(const Query *query, const QueryRow *a, const QueryRow *b);
+static void sift_down(const Query *query, RowHeap *heap, const QueryRow *item);
+static void heap_offer(const Query *query, RowHeap *heap, const QueryRow *item);
+static int thread_count(void);
+static int thread_index(void);
+static void print_plan(const QueryPlan *plan);
+static void print_header(const QueryPlan *plan);
+static void print_row(const QueryPlan *plan, const QueryRow *row);
+static double now_seconds(void);
+
+static const char *column_names[QUERY_COLUMN_COUNT] = {
+    "V1_X", "V1_Y", "V1_Z", "V1_MAG",
+    "V2_X", "V2_Y", "V2_Z", "V2_MAG",
+    "V3_X", "V3_Y", "V3_Z", "V3_MAG",
+    "EXPECTED_VOLUME",
+    "ROW", "VOLUME", "ERROR", "CROSS_MAG", "DOT12", "DOT13", "DOT23", "COPLANARITY"
+};
+
+static const char *operator_names[] = { "<", "<=", ">", ">=", "==", "!=" };
+
+static bool names_equal(const char *a, const char *b) {
+    for (; *a != '\0' || *b != '\0'; a++, b++) {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) return false;
+    }
+    return true;
+}
+
+static const char *skip_spaces(const char *cursor) {
+    while (isspace((unsigned char)*cursor)) cursor++;
+    return cursor;
+}
+
+static bool parse_operator(const char **cursor, QueryOperator *op) {
+    static const struct { const char *text; QueryOperator op; } operators[] = {
+        { "<=", QUERY_LE }, { ">=", QUERY_GE }, { "==", QUERY_EQ }, { "!=", QUERY_NE },
+        { "<", QUERY_LT }, { ">", QUERY_GT }, { "=", QUERY_EQ },
+    };
+
+    for (size_t i = 0; i < sizeof(operators) / sizeof(operators[0]); i++) {
+        size_t length = strlen(operators[i].text);
+        if (strncmp(*cursor, operators[i].text, length) == 0) {
+            *op = operators[i].op;
+            *cursor += length;
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- Parsing ---
+
+bool query_column_from_name(const char *name, QueryColumn *column) {
+    for (int c = 0; c < QUERY_COLUMN_COUNT; c++) {
+        if (names_equal(name, column_names[c])) {
+            *column = (QueryColumn)c;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool query_parse_where(const char *text, Query *query, char *error, size_t error_size) {
+    const char *cursor = text;
+
+    for (;;) {
+        QueryCondition condition;
+        char name[QUERY_NAME_LENGTH];
+        size_t length = 0;
+        char *end;
+
+        cursor = skip_spaces(cursor);
+        while (isalnum((unsigned char)*cursor) || *cursor == '_') {
+            if (length + 1 < sizeof(name)) name[length++] = *cursor;
+            cursor++;
+        }
+        name[length] = '\0';
+        if (length == 0) {
+            snprintf(error, error_size, "Expected a column name at '%s'", cursor);
+            return false;
+        }
+        if (!query_column_from_name(name, &condition.column)) {
+            snprintf(error, error_size, "Unknown column '%s'", name);
+            return false;
+        }
+
+        cursor = skip_spaces(cursor);
+        if (!parse_operator(&cursor, &condition.op)) {
+            snprintf(error, error_size, "Expected <, <=, >, >=, == or != after '%s'", name);
+            return false;
+        }
+        condition.value = strtod(cursor, &end);
+        if (end == cursor) {
+            snprintf(error, error_size, "Expected a number after '%s %s'", name, operator_names[condition.op]);
+            return false;
+        }
+        if (query->condition_count == QUERY_MAX_CONDITIONS) {
+            snprintf(error, error_size, "More than %d conditions", QUERY_MAX_CONDITIONS);
+            return false;
+        }
+        query->conditions[query->condition_count++] = condition;
+
+        cursor = skip_spaces(end);
+        if (*cursor == '\0') return true;
+        if (*cursor == ',') {
+            cursor++;
+        } else if (cursor[0] == '&' && cursor[1] == '&') {
+            cursor += 2;
+        } else if (tolower((unsigned char)cursor[0]) == 'a' && tolower((unsigned char)cursor[1]) == 'n' &&
+                   tolower((unsigned char)cursor[2]) == 'd' && !isalnum((unsigned char)cursor[3]) && cursor[3] != '_') {
+            cursor += 3;
+        } else {
+            snprintf(error, error_size, "Unexpected '%s' (join conditions with 'and')", cursor);
+            return false;
+        }
+    }
+}
+
+// --- Scan Plan ---
+
+static ColumnCost column_cost(QueryColumn column) {
+    if (column == QUERY_COL_ROW) return COST_ROW;
+    if (column < QUERY_COL_ROW) return COST_INPUT;
+    if (column == QUERY_COL_VOLUME || column == QUERY_COL_ERROR || column == QUERY_COL_COPLANARITY) return COST_VOLUME;
+    return COST_PRODUCT;
+}
+
+// CSV columns a query column is computed from
+static unsigned column_mask(QueryColumn column) {
+    switch (column) {
+        case QUERY_COL_ROW:         return 0;
+        case QUERY_COL_VOLUME:
+        case QUERY_COL_COPLANARITY: return CSV_MASK_VECTORS;
+        case QUERY_COL_ERROR:       return CSV_MASK_VECTORS | CSV_MASK_EXPECTED;
+        case QUERY_COL_CROSS_MAG:
+        case QUERY_COL_DOT12:       return CSV_MASK_V1 | CSV_MASK_V2;
+        case QUERY_COL_DOT13:       return CSV_MASK_V1 | CSV_MASK_V3;
+        case QUERY_COL_DOT23:       return CSV_MASK_V2 | CSV_MASK_V3;
+        default:                    return CSV_MASK((CsvColumn)column);
+    }
+}
+
+static void plan_query(const Query *query, QueryPlan *plan) {
+    bool printed[QUERY_COLUMN_COUNT] = { false };
+
+    plan->query = query;
+    plan->condition_count = query->condition_count;
+    plan->row_conditions = 0;
+    plan->output_count = 0;
+    plan->mask = column_mask(query->order_by);
+
+    // Stable insertion sort by cost, so cheap conditions reject rows first
+    for (int i = 0; i < query->condition_count; i++) {
+        QueryCondition condition = query->conditions[i];
+        int slot = i;
+        while (slot > 0 && column_cost(plan->conditions[slot - 1].column) > column_cost(condition.column)) {
+            plan->conditions[slot] = plan->conditions[slot - 1];
+            slot--;
+        }
+        plan->conditions[slot] = condition;
+        plan->mask |= column_mask(condition.column);
+        if (condition.column == QUERY_COL_ROW) plan->row_conditions++;
+    }
+
+    // Ranking column first, then the filtered ones
+    printed[QUERY_COL_ROW] = true;
+    if (!printed[query->order_by]) {
+        printed[query->order_by] = true;
+        plan->outputs[plan->output_count++] = query->order_by;
+    }
+    for (int i = 0; i < query->condition_count; i++) {
+        QueryColumn column = query->conditions[i].column;
+        if (printed[column]) continue;
+        printed[column] = true;
+        plan->outputs[plan->output_count++] = column;
+    }
+}
+
+// --- Evaluation ---
+
+static double column_value(RowValues *row, QueryColumn column) {
+    const TestCase *test = row->test;
+    double value;
+
+    if (row->known & (1u << column)) return row->values[column];
+
+    switch (column) {
+        case QUERY_COL_ROW:
+            value = (double)row->row;
+            break;
+        case QUERY_COL_VOLUME:
+            // Integer rows take the exact path, as in the volume runner
+            if (test->integer_coordinates) {
+                value = volumeParallelepipedExact(test->int_coordinates, row->k_value);
+            } else {
+                vector vectors[3] = { test->v1, test->v2, test->v3 };
+                value = volumeParallelepiped(vectors, row->k_value);
+            }
+            break;
+        case QUERY_COL_ERROR:
+            value = fabs(column_value(row, QUERY_COL_VOLUME) - test->expected_volume / row->k_value);
+            break;
+        case QUERY_COL_CROSS_MAG:
+            value = crossProduct(test->v1, test->v2).magnitude;
+            break;
+        case QUERY_COL_DOT12:
+            value = scalaricProduct(test->v1, test->v2);
+            break;
+        case QUERY_COL_DOT13:
+            value = scalaricProduct(test->v1, test->v3);
+            break;
+        case QUERY_COL_DOT23:
+            value = scalaricProduct(test->v2, test->v3);
+            break;
+        case QUERY_COL_COPLANARITY: {
+            double norms = sqrt(scalaricProduct(test->v1, test->v1)) * sqrt(scalaricProduct(test->v2, test->v2)) *
+                           sqrt(scalaricProduct(test->v3, test->v3));
+            value = norms > 0.0 ? column_value(row, QUERY_COL_VOLUME) * row->k_value / norms : 0.0;
+            break;
+        }
+        default: {
+            // Input column: four per vector (x, y, z, magnitude), then the expected volume
+            const vector *vectors[3] = { &test->v1, &test->v2, &test->v3 };
+            if (column == (QueryColumn)CSV_COL_EXPECTED_VOLUME) {
+                value = test->expected_volume;
+            } else {
+                const vector *v = vectors[column / 4];
+                value = column % 4 == 3 ? v->magnitude : v->direction[column % 4];
+            }
+            break;
+        }
+    }
+
+    row->values[column] = value;
+    row->known |= 1u << column;
+    return value;
+}
+
+static bool compare(double value, QueryOperator op, double operand) {
+    switch (op) {
+        case QUERY_LT: return value < operand;
+        case QUERY_LE: return value <= operand;
+        case QUERY_GT: return value > operand;
+        case QUERY_GE: return value >= operand;
+        case QUERY_EQ: return value == operand;
+        case QUERY_NE: return value != operand;
+    }
+    return false;
+}
+
+// Whether a failed ROW condition also fails every later row
+static bool past_row_bound(const QueryCondition *condition, long long row) {
+    switch (condition->op) {
+        case QUERY_LT: return row >= condition->value;
+        case QUERY_LE:
+        case QUERY_EQ: return row > condition->value;
+        default:       return false;
+    }
+}
+
+// Conditions after the ROW ones, cheapest first; stops at the first failure
+static bool row_matches(const QueryPlan *plan, RowValues *row) {
+    for (int i = plan->row_conditions; i < plan->condition_count; i++) {
+        const QueryCondition *condition = &plan->conditions[i];
+        if (!compare(column_value(row, condition->column), condition->op, condition->value)) return false;
+    }
+    return true;
+}
+
+// --- Top-K ---
+
+// Ranking order; ties go to the earlier row
+static bool better_row(const Query *query, const QueryRow *a, const QueryRow *b) {
+    double x = a->values[query->order_by], y = b->values[query->order_by];
+    if (x != y) return query->ascending ? x < y : x > y;
+    return a->row < b->row;
+}
+
+// Puts item in place of the root and restores the heap order
+static void sift_down(const Query *query, RowHeap *heap, const QueryRow *item) {
+    size_t node = 0;
+
+    for (;;) {
+        size_t child = 2 * node + 1;
+        if (child >= heap->count) break;
+        if (child + 1 < heap->count && better_row(query, &heap->items[child], &heap->items[child + 1])) child++;
+        if (!better_row(query, item, &heap->items[child])) break;
+        heap->items[node] = heap->items[child];
+        node = child;
+    }
+    heap->items[node] = *item;
+}
+
+static void heap_offer(const Query *query, RowHeap *heap, const QueryRow *item) {
+    size_t node;
+
+    if (heap->count == heap->capacity) {
+        if (better_row(query, item, &heap->items[0])) sift_down(query, heap, item);
+        return;
+    }
+
+    // Sift up from the new leaf
+    node = heap->count++;
+    while (node > 0) {
+        size_t parent = (node - 1) / 2;
+        if (!better_row(query, &heap->items[parent], item)) break;
+        heap->items[node] = heap->items[parent];
+        node = parent;
+    }
+    heap->items[node] = *item;
+}
+
+static int thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+static int thread_index(void) {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+// --- Output ---
+
+static void print_plan(const QueryPlan *plan) {
+    const Query *query = plan->query;
+
+    printf("\n=== Query (k=%.1f) ===\n", query->k_value);
+    if (query->condition_count > 0) {
+        printf("Where:");
+        for (int i = 0; i < query->condition_count; i++) {
+            const QueryCondition *condition = &query->conditions[i];
+            printf("%s %s %s %.10g", i > 0 ? " and" : "", column_names[condition->column],
+                   operator_names[condition->op], condition->value);
+        }
+        printf("\n");
+    }
+    if (query->top_k > 0) {
+        printf("Top %zu by %s (%s first)\n", query->top_k, column_names[query->order_by],
+               query->ascending ? "smallest" : "largest");
+    }
+}
+
+static void print_header(const QueryPlan *plan) {
+    printf("\n%10s", "Row");
+    for (int i = 0; i < plan->output_count; i++) printf(" %16s", column_names[plan->outputs[i]]);
+    printf("\n");
+}
+
+static void print_row(const QueryPlan *plan, const QueryRow *row) {
+    printf("%10lld", row->row);
+    for (int i = 0; i < plan->output_count; i++) printf(" %16.10g", row->values[plan->outputs[i]]);
+    printf("\n");
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// --- Query Runner ---
+
+int run_query(CsvFile *csv, const Query *query) {
+    QueryPlan plan;
+    int threads = thread_count();
+    size_t top_k = query->top_k;
+    TestCase *tests;
+    QueryRow *results = NULL, *all = NULL;
+    RowHeap *heaps = NULL;
+    unsigned char *states;
+    long long *rows;
+    long long matched = 0;
+    long long row = 0, error_count = 0;
+    bool scanning = true;
+
+    plan_query(query, &plan);
+    print_plan(&plan);
+
+    csv_rewind(csv);
+    if (!csv_read_line(csv)) {
+        printf("ERROR: Cannot read CSV header\n");
+        if (csv_error(csv) != NULL) printf("ERROR: %s\n", csv_error(csv));
+        return 1;
+    }
+    csv_map_header(csv);
+    if (!csv_has_columns(csv, plan.mask)) {
+        printf("ERROR: CSV header is missing columns required by this query\n");
+        return 1;
+    }
+
+    tests = (TestCase*)malloc(QUERY_BLOCK_ROWS * sizeof(TestCase));
+    rows = (long long*)malloc(QUERY_BLOCK_ROWS * sizeof(long long));
+    states = (unsigned char*)malloc(QUERY_BLOCK_ROWS);
+    if (top_k > 0) {
+        heaps = (RowHeap*)calloc((size_t)threads, sizeof(RowHeap));
+        all = (QueryRow*)malloc((size_t)threads * top_k * sizeof(QueryRow));
+    } else {
+        results = (QueryRow*)malloc(QUERY_BLOCK_ROWS * sizeof(QueryRow));
+    }
+    if (tests == NULL || rows == NULL || states == NULL || (top_k > 0 ? heaps == NULL || all == NULL : results == NULL)) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        free(tests);
+        free(rows);
+        free(states);
+        free(heaps);
+        free(all);
+        free(results);
+        return 1;
+    }
+    for (int t = 0; t < threads && top_k > 0; t++) {
+        heaps[t].items = all + (size_t)t * top_k;
+        heaps[t].capacity = top_k;
+    }
+
+    if (top_k == 0) print_header(&plan);
+    double start_time = now_seconds();
+
+    while (scanning) {
+        int block_rows = 0;
+
+        // Serial part: read lines, reject on the row number before decoding,
+        // then decode only the planned columns
+        while (block_rows < QUERY_BLOCK_ROWS && csv_read_line(csv)) {
+            bool wanted = true;
+
+            row++;
+            for (int i = 0; i < plan.row_conditions && wanted; i++) {
+                if (compare((double)row, plan.conditions[i].op, plan.conditions[i].value)) continue;
+                wanted = false;
+                if (past_row_bound(&plan.conditions[i], row)) scanning = false;
+            }
+            if (!scanning) {
+                row--; // Not part of the scan
+                break;
+            }
+
+            rows[block_rows] = row;
+            states[block_rows] = ROW_SKIPPED;
+            if (wanted) {
+                if (csv_read_test_case_columns(csv, &tests[block_rows], plan.mask)) {
+                    states[block_rows] = ROW_PARSED;
+                } else {
+                    error_count++;
+                }
+            }
+            block_rows++;
+        }
+        if (block_rows < QUERY_BLOCK_ROWS) scanning = false;
+
+        // Parallel part: filter, then keep the row (filter only) or offer it to
+        // this thread's heap
+        #pragma omp parallel for schedule(static) reduction(+:matched)
+        for (int i = 0; i < block_rows; i++) {
+            RowValues values;
+            QueryRow result;
+
+            if (states[i] != ROW_PARSED) continue;
+            values.test = &tests[i];
+            values.row = rows[i];
+            values.k_value = query->k_value;
+            values.known = 0;
+            if (!row_matches(&plan, &values)) continue;
+
+            matched++;
+            result.row = rows[i];
+            for (int o = 0; o < plan.output_count; o++) {
+                result.values[plan.outputs[o]] = column_value(&values, plan.outputs[o]);
+            }
+            if (top_k == 0) {
+                results[i] = result;
+                states[i] = ROW_MATCHED;
+            } else if (!isnan(result.values[query->order_by])) {
+                heap_offer(query, &heaps[thread_index()], &result);
+            }
+        }
+
+        if (top_k == 0) {
+            for (int i = 0; i < block_rows; i++) {
+                if (states[i] == ROW_MATCHED) print_row(&plan, &results[i]);
+            }
+        }
+    }
+    double elapsed = now_seconds() - start_time;
+
+    if (top_k > 0) {
+        // The best k overall are among the threads' best k: merge into the
+        // first heap, then pop its worst row to the back until it is sorted
+        RowHeap *best = &heaps[0];
+        for (int t = 1; t < threads; t++) {
+            for (size_t i = 0; i < heaps[t].count; i++) heap_offer(query, best, &heaps[t].items[i]);
+        }
+        size_t count = best->count;
+        while (best->count > 1) {
+            QueryRow last = best->items[--best->count];
+            best->items[best->count] = best->items[0];
+            sift_down(query, best, &last);
+        }
+
+        print_header(&plan);
+        for (size_t i = 0; i < count; i++) print_row(&plan, &best->items[i]);
+    }
+
+    printf("\n--- Query Summary ---\n");
+    printf("Rows scanned: %lld | Matched: %lld | Errors: %lld\n", row, matched, error_count);
+    printf("Time: %.3f s (%.3e rows/s)\n\n", elapsed, elapsed > 0.0 ? (double)row / elapsed : 0.0);
+    // A scan cut short by a read error did not see every row
+    bool complete = csv_error(csv) == NULL;
+    if (!complete) printf("ERROR: %s (stopped after row %lld)\n", csv_error(csv), row);
+
+    free(tests);
+    free(rows);
+    free(states);
+    free(heaps);
+    free(all);
+    free(results);
+    return complete ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+#ifndef QUERY_ENGINE_H
+#define QUERY_ENGINE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "csvHandler.h"
+
+#define QUERY_MAX_CONDITIONS 16
+
+// --- Columns ---
+// The input columns come first (same values as CsvColumn), then the computed ones
+typedef enum {
+    QUERY_COL_ROW = CSV_COLUMN_COUNT, // Test number, as printed by the runners
+    QUERY_COL_VOLUME,                 // Computed volume, divided by the query's k
+    QUERY_COL_ERROR,                  // |VOLUME - EXPECTED_VOLUME / k|
+    QUERY_COL_CROSS_MAG,              // |V1 x V2|
+    QUERY_COL_DOT12,                  // V1 · V2
+    QUERY_COL_DOT13,                  // V1 · V3
+    QUERY_COL_DOT23,                  // V2 · V3
+    QUERY_COL_COPLANARITY,            // |V1 · (V2 x V3)| / (|V1| |V2| |V3|): 0 = coplanar, 1 = orthogonal
+    QUERY_COLUMN_COUNT
+} QueryColumn;
+
+typedef enum {
+    QUERY_LT, QUERY_LE, QUERY_GT, QUERY_GE, QUERY_EQ, QUERY_NE
+} QueryOperator;
+
+// COLUMN OP VALUE
+typedef struct {
+    QueryColumn column;
+    QueryOperator op;
+    double value;
+} QueryCondition;
+
+// --- Query ---
+// Rows matching every condition are printed in file order, or only the top_k
+// of them ordered by order_by when top_k > 0
+typedef struct {
+    QueryCondition conditions[QUERY_MAX_CONDITIONS];
+    int condition_count;
+    size_t top_k;          // 0 = print every match
+    QueryColumn order_by;  // Ranking column for top_k
+    bool ascending;        // Smallest first instead of largest first
+    double k_value;        // Volume divisor (1 parallelepiped, 6 pyramid)
+} Query;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Looks up a column by name (input names like V1_X or EXPECTED_VOLUME,
+ * or ROW, VOLUME, ERROR, CROSS_MAG, DOT12, DOT13, DOT23, COPLANARITY; any case)
+ * @param name Column name
+ * @param column Receives the column
+ * @return true if the name is known
+ */
+bool query_column_from_name(const char *name, QueryColumn *column);
+
+/**
+ * @brief Parses a filter such as "CROSS_MAG > 100 and V1_X >= 0" into the
+ * query's conditions (comparisons joined by "and", "&&" or ",")
+ * @param text Filter text
+ * @param query Query to add the conditions to
+ * @param error Receives a message on failure
+ * @param error_size Size of error
+ * @return true on success
+ */
+bool query_parse_where(const char *text, Query *query, char *error, size_t error_size);
+
+/**
+ * @brief Scans a test file once and prints the rows selected by the query.
+ * Only the columns the query needs are decoded. Conditions on input columns
+ * are checked before anything is computed, and computed columns are only
+ * evaluated when a condition or the ranking needs them. Parsed blocks are
+ * filtered in parallel, with one top-k heap per thread.
+ * @param csv Opened CSV file pointer
+ * @param query Query to run
+ * @return 0 on success, 1 on error
+ */
+int run_query(CsvFile *csv, const Query *query);
+
+#endif // QUERY_ENGINE_H
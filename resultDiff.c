@@ -0,0 +1,342 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include "resultDiff.h"
+#include "resultFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define DIFF_CHUNK_ROWS 65536
+#define ULP_BUCKETS 65                // 0 ulps, then [2^k, 2^(k+1)) for k = 0..63
+#define NAN_BUCKET ULP_BUCKETS        // Exactly one side is NaN
+#define HISTOGRAM_SIZE (ULP_BUCKETS + 1)
+#define HISTOGRAM_BAR 40
+
+// --- Data Structures ---
+
+typedef struct {
+    uint64_t failures;
+    uint64_t nan_mismatches;
+    double max_abs;
+    double max_rel;
+    uint64_t max_ulp;
+} ColumnStats;
+
+typedef struct {
+    uint64_t row;
+    int column;
+    double a, b;
+    uint64_t ulps;  // UINT64_MAX for a NaN mismatch
+    bool failed;
+} Offender;
+
+typedef struct {
+    const DiffOptions *options;
+    ColumnStats columns[RESULT_MAX_COLUMNS];
+    uint64_t histogram[HISTOGRAM_SIZE];
+    Offender worst[DIFF_MAX_WORST];
+    int worst_count;
+    uint64_t compared;
+} DiffState;
+
+typedef struct {
+    double *block_a, *block_b; // Column-major blocks of DIFF_CHUNK_ROWS rows
+    double *abs_diff;
+    uint64_t *ulps;
+} DiffBuffers;
+
+// --- Helper Prototypes ---
+static double now_seconds(void);
+static uint64_t ulp_distance(double a, double b);
+static int ulp_bucket(uint64_t ulps);
+static void compare_block(const double *a, const double *b, size_t count, double *abs_diff, uint64_t *ulps);
+static void record_offender(DiffState *state, const Offender *offender);
+static void accumulate_block(DiffState *state, int column, uint64_t first_row, const double *a, const double *b,
+                             const double *abs_diff, const uint64_t *ulps, size_t count);
+static void print_report(const DiffState *state, const ResultReader *reader, int columns);
+static void stream_files(DiffState *state, ResultReader *a, ResultReader *b, int columns,
+                         const DiffBuffers *buffers, uint64_t *rows, uint64_t *extra_rows);
+
+static double now_seconds(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+// --- Comparison Kernels ---
+
+// Number of representable doubles between a and b (+0 and -0 are 0 apart)
+static inline uint64_t ulp_distance(double a, double b) {
+    int64_t ia, ib;
+    memcpy(&ia, &a, sizeof(ia));
+    memcpy(&ib, &b, sizeof(ib));
+    if (ia < 0) ia = INT64_MIN - ia; // Map negative doubles below the positive ones
+    if (ib < 0) ib = INT64_MIN - ib;
+    return ia > ib ? (uint64_t)ia - (uint64_t)ib : (uint64_t)ib - (uint64_t)ia;
+}
+
+static int ulp_bucket(uint64_t ulps) {
+    int bucket = 0;
+    while (ulps != 0) {
+        ulps >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+// Branch-free pass over a column block, vectorized with OpenMP SIMD when enabled
+static void compare_block(const double *a, const double *b, size_t count, double *abs_diff, uint64_t *ulps) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; i++) {
+        abs_diff[i] = fabs(a[i] - b[i]);
+        ulps[i] = ulp_distance(a[i], b[i]);
+    }
+}
+
+// Keeps the worst offenders sorted by ULP distance, largest first
+static void record_offender(DiffState *state, const Offender *offender) {
+    int limit = state->options->worst_count;
+    int position = state->worst_count;
+
+    if (limit <= 0) return;
+    if (position == limit) {
+        if (offender->ulps <= state->worst[limit - 1].ulps) return;
+        position--;
+    } else {
+        state->worst_count++;
+    }
+    while (position > 0 && state->worst[position - 1].ulps < offender->ulps) {
+        state->worst[position] = state->worst[position - 1];
+        position--;
+    }
+    state->worst[position] = *offender;
+}
+
+static void accumulate_block(DiffState *state, int column, uint64_t first_row, const double *a, const double *b,
+                             const double *abs_diff, const uint64_t *ulps, size_t count) {
+    const DiffOptions *options = state->options;
+    ColumnStats *stats = &state->columns[column];
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t distance = ulps[i];
+        double difference = abs_diff[i];
+        bool failed;
+
+        if (distance == 0) { // Identical (the common case)
+            state->histogram[0]++;
+            continue;
+        }
+
+        if (isnan(a[i]) || isnan(b[i])) {
+            if (isnan(a[i]) && isnan(b[i])) {
+                state->histogram[0]++;
+                continue;
+            }
+            state->histogram[NAN_BUCKET]++;
+            stats->nan_mismatches++;
+            distance = UINT64_MAX;
+            failed = true;
+        } else {
+            double scale = fmax(fabs(a[i]), fabs(b[i]));
+            double relative = difference / scale;
+
+            state->histogram[ulp_bucket(distance)]++;
+            if (difference > stats->max_abs) stats->max_abs = difference;
+            if (relative > stats->max_rel) stats->max_rel = relative;
+            if (distance > stats->max_ulp) stats->max_ulp = distance;
+
+            failed = !(difference <= options->abs_tolerance ||
+                       difference <= options->rel_tolerance * scale ||
+                       distance <= options->ulp_tolerance);
+        }
+
+        if (failed) stats->failures++;
+        Offender offender = { first_row + i, column, a[i], b[i], distance, failed };
+        record_offender(state, &offender);
+    }
+}
+
+// --- Report ---
+
+static void print_report(const DiffState *state, const ResultReader *reader, int columns) {
+    printf("\n%-20s %14s %12s %12s %12s\n", "Column", "Failures", "Max abs", "Max rel", "Max ULP");
+    for (int c = 0; c < columns; c++) {
+        const ColumnStats *stats = &state->columns[c];
+        printf("%-20s %14llu %12.3e %12.3e %12llu", result_reader_column_name(reader, c),
+               (unsigned long long)stats->failures, stats->max_abs, stats->max_rel,
+               (unsigned long long)stats->max_ulp);
+        if (stats->nan_mismatches > 0) printf("  (%llu NaN mismatches)", (unsigned long long)stats->nan_mismatches);
+        printf("\n");
+    }
+
+    uint64_t largest = 0;
+    for (int b = 0; b < HISTOGRAM_SIZE; b++) {
+        if (state->histogram[b] > largest) largest = state->histogram[b];
+    }
+
+    printf("\nULP distance histogram:\n");
+    for (int b = 0; b < HISTOGRAM_SIZE; b++) {
+        char label[32];
+        uint64_t count = state->histogram[b];
+        if (count == 0) continue;
+
+        if (b == 0) snprintf(label, sizeof(label), "identical");
+        else if (b == NAN_BUCKET) snprintf(label, sizeof(label), "NaN mismatch");
+        else snprintf(label, sizeof(label), "[2^%d, 2^%d)", b - 1, b);
+
+        int bar = (int)((double)count / (double)largest * HISTOGRAM_BAR + 0.5);
+        printf("  %-14s %14llu %7.3f%%  ", label, (unsigned long long)count,
+               100.0 * (double)count / (double)(state->compared ? state->compared : 1));
+        for (int i = 0; i < (bar > 0 ? bar : 1); i++) putchar('#');
+        printf("\n");
+    }
+
+    if (state->worst_count > 0) {
+        printf("\nWorst offenders:\n");
+        printf("  %-14s %-20s %24s %24s %12s  %s\n", "Row", "Column", "A", "B", "ULPs", "Status");
+        for (int i = 0; i < state->worst_count; i++) {
+            const Offender *o = &state->worst[i];
+            char ulps[24];
+            if (o->ulps == UINT64_MAX) snprintf(ulps, sizeof(ulps), "NaN");
+            else snprintf(ulps, sizeof(ulps), "%llu", (unsigned long long)o->ulps);
+            printf("  %-14llu %-20s %24.17g %24.17g %12s  %s\n", (unsigned long long)o->row,
+                   result_reader_column_name(reader, o->column), o->a, o->b, ulps, o->failed ? "FAIL" : "ok");
+        }
+    }
+}
+
+// Reads both files block by block and compares the shared columns of the shared rows
+static void stream_files(DiffState *state, ResultReader *a, ResultReader *b, int columns,
+                         const DiffBuffers *buffers, uint64_t *rows, uint64_t *extra_rows) {
+    *rows = *extra_rows = 0;
+
+    for (;;) {
+        size_t rows_a = result_reader_read(a, buffers->block_a, DIFF_CHUNK_ROWS);
+        size_t rows_b = result_reader_read(b, buffers->block_b, DIFF_CHUNK_ROWS);
+        size_t common = rows_a < rows_b ? rows_a : rows_b;
+
+        for (int c = 0; c < columns; c++) {
+            const double *column_a = &buffers->block_a[(size_t)c * DIFF_CHUNK_ROWS];
+            const double *column_b = &buffers->block_b[(size_t)c * DIFF_CHUNK_ROWS];
+            compare_block(column_a, column_b, common, buffers->abs_diff, buffers->ulps);
+            accumulate_block(state, c, *rows, column_a, column_b, buffers->abs_diff, buffers->ulps, common);
+        }
+        state->compared += (uint64_t)common * (uint64_t)columns;
+        *rows += common;
+
+        if (rows_a != rows_b) {
+            // One file ended: count what is left of the other
+            ResultReader *longer = rows_a > rows_b ? a : b;
+            double *block = rows_a > rows_b ? buffers->block_a : buffers->block_b;
+            size_t more;
+
+            *extra_rows += (rows_a > rows_b ? rows_a : rows_b) - common;
+            while ((more = result_reader_read(longer, block, DIFF_CHUNK_ROWS)) > 0) *extra_rows += more;
+            return;
+        }
+        if (common == 0) return;
+    }
+}
+
+int run_result_diff(const char *path_a, const char *path_b, const DiffOptions *options) {
+    ResultReader *a = result_reader_open(path_a);
+    ResultReader *b = result_reader_open(path_b);
+    DiffState *state = (DiffState*)calloc(1, sizeof(DiffState));
+    DiffBuffers buffers = { NULL, NULL, NULL, NULL };
+    int exit_code = 0;
+
+    if (a == NULL || b == NULL || state == NULL) {
+        result_reader_close(a);
+        result_reader_close(b);
+        free(state);
+        return 1;
+    }
+    state->options = options;
+
+    int columns_a = result_reader_column_count(a), columns_b = result_reader_column_count(b);
+    int columns = columns_a < columns_b ? columns_a : columns_b;
+
+    buffers.block_a = (double*)malloc((size_t)columns_a * DIFF_CHUNK_ROWS * sizeof(double));
+    buffers.block_b = (double*)malloc((size_t)columns_b * DIFF_CHUNK_ROWS * sizeof(double));
+    buffers.abs_diff = (double*)malloc(DIFF_CHUNK_ROWS * sizeof(double));
+    buffers.ulps = (uint64_t*)malloc(DIFF_CHUNK_ROWS * sizeof(uint64_t));
+
+    if (buffers.block_a == NULL || buffers.block_b == NULL || buffers.abs_diff == NULL || buffers.ulps == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        exit_code = 1;
+    } else {
+        printf("\n=== Result Diff ===\n");
+        printf("A: %s (%s, %d columns)\n", path_a, result_reader_is_binary(a) ? "binary" : "text", columns_a);
+        printf("B: %s (%s, %d columns)\n", path_b, result_reader_is_binary(b) ? "binary" : "text", columns_b);
+        printf("Tolerances: abs %g | rel %g | ulp %llu\n", options->abs_tolerance, options->rel_tolerance,
+               (unsigned long long)options->ulp_tolerance);
+
+        if (columns_a != columns_b) {
+            printf("Column counts differ; comparing the first %d columns.\n", columns);
+            exit_code = 2;
+        }
+        for (int c = 0; c < columns; c++) {
+            if (strcmp(result_reader_column_name(a, c), result_reader_column_name(b, c)) != 0) {
+                printf("Note: column %d is '%s' in A but '%s' in B.\n", c + 1,
+                       result_reader_column_name(a, c), result_reader_column_name(b, c));
+            }
+        }
+
+        uint64_t rows, extra_rows;
+        double start = now_seconds();
+        stream_files(state, a, b, columns, &buffers, &rows, &extra_rows);
+        double elapsed = now_seconds() - start;
+
+        if (result_reader_failed(a) || result_reader_failed(b)) {
+            ResultReader *failed = result_reader_failed(a) ? a : b;
+            fprintf(stderr, "Error: Could not read %s: %s.\n", failed == a ? path_a : path_b,
+                    result_reader_error(failed));
+            exit_code = 1;
+        } else {
+            uint64_t failures = 0;
+            for (int c = 0; c < columns; c++) failures += state->columns[c].failures;
+
+            print_report(state, a, columns);
+
+            double bytes = 2.0 * (double)state->compared * sizeof(double);
+            printf("\nRows compared: %llu | Values: %llu | %.3f s (%.1f MB/s of values)\n",
+                   (unsigned long long)rows, (unsigned long long)state->compared, elapsed,
+                   elapsed > 0.0 ? bytes / elapsed / 1e6 : 0.0);
+            if (extra_rows > 0) {
+                printf("Row counts differ: %llu extra rows in the longer file.\n", (unsigned long long)extra_rows);
+                exit_code = 2;
+            }
+
+            if (failures > 0) {
+                printf("\n✗ %llu value(s) outside tolerance.\n", (unsigned long long)failures);
+                exit_code = 2;
+            } else if (exit_code == 0) {
+                printf("\n✓ All values within tolerance.\n");
+            }
+        }
+    }
+
+    free(buffers.block_a);
+    free(buffers.block_b);
+    free(buffers.abs_diff);
+    free(buffers.ulps);
+    free(state);
+    result_reader_close(a);
+    result_reader_close(b);
+    return exit_code;
+}
@@ -0,0 +1,28 @@
+#ifndef RESULT_DIFF_H
+#define RESULT_DIFF_H
+
+#include <stdint.h>
+
+#define DIFF_MAX_WORST 100
+
+// --- Diff Configuration ---
+// A pair of values matches when ANY tolerance accepts it; all zero means exact.
+typedef struct {
+    double abs_tolerance;    // |a - b| <= abs_tolerance
+    double rel_tolerance;    // |a - b| <= rel_tolerance * max(|a|, |b|)
+    uint64_t ulp_tolerance;  // a and b at most this many doubles apart
+    int worst_count;         // Worst offenders to list (at most DIFF_MAX_WORST)
+} DiffOptions;
+
+/**
+ * @brief Streams two result files (binary or CSV text, see resultFile.h) and
+ * compares them column by column. Prints per-column statistics, a histogram
+ * of ULP distances and the worst offenders.
+ * @param path_a Reference result file
+ * @param path_b Result file to check
+ * @param options Tolerances and report size
+ * @return 0 if every value matches, 2 if any differs (or the shapes differ), 1 on error
+ */
+int run_result_diff(const char *path_a, const char *path_b, const DiffOptions *options);
+
+#endif // RESULT_DIFF_H
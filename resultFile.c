@@ -0,0 +1,348 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "resultFile.h"
+#include "csvHandler.h"
+
+#ifdef _WIN32
+#define fseeko _fseeki64
+typedef long long off_t_64;
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+typedef off_t off_t_64;
+#endif
+
+#define RESULT_DATA_ALIGNMENT 64 // Columns start on a cache line
+
+// --- Data Structures ---
+
+struct ResultReader {
+    FILE *file;      // Binary files
+    CsvFile *csv;    // Text files
+    int column_count;
+    char names[RESULT_MAX_COLUMNS][RESULT_NAME_LENGTH];
+    uint64_t row_count;   // Binary files only
+    uint64_t next_row;
+    uint64_t data_offset;
+    char *line;           // Text files: current line, grown as needed
+    size_t line_capacity;
+    bool failed;
+    char error[CSV_ERROR_LENGTH]; // Why the reader failed
+};
+
+struct ResultWriter {
+    unsigned char *base; // Whole file: header, names, columns
+    size_t size;
+    uint64_t row_count;
+    uint32_t data_offset;
+    int column_count;
+#ifdef _WIN32
+    FILE *file;          // No mapping: the buffer is written out on close
+#else
+    int fd;
+#endif
+};
+
+// --- Helper Prototypes ---
+static bool open_binary(ResultReader *reader, const char *path);
+static bool open_text(ResultReader *reader, const char *path);
+static size_t read_binary(ResultReader *reader, double *values, size_t max_rows);
+static size_t read_text(ResultReader *reader, double *values, size_t max_rows);
+static int split_fields(char *line, char *fields[], int max_fields);
+static bool map_file(ResultWriter *writer, const char *path);
+
+// Returns false when the file is not in the binary format (or cannot be opened)
+static bool open_binary(ResultReader *reader, const char *path) {
+    ResultFileHeader header;
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) return false;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != RESULT_FILE_MAGIC) {
+        fclose(file);
+        return false;
+    }
+
+    if (header.version != RESULT_FILE_VERSION || header.column_count == 0 ||
+        header.column_count > RESULT_MAX_COLUMNS ||
+        header.data_offset < sizeof(header) + (uint64_t)header.column_count * RESULT_NAME_LENGTH) {
+        fprintf(stderr, "Error: '%s' has an unsupported result file header.\n", path);
+        reader->failed = true;
+        fclose(file);
+        return false;
+    }
+
+    for (uint32_t c = 0; c < header.column_count; c++) {
+        if (fread(reader->names[c], RESULT_NAME_LENGTH, 1, file) != 1) {
+            fprintf(stderr, "Error: '%s' is truncated.\n", path);
+            reader->failed = true;
+            fclose(file);
+            return false;
+        }
+        reader->names[c][RESULT_NAME_LENGTH - 1] = '\0';
+    }
+
+    reader->file = file;
+    reader->column_count = (int)header.column_count;
+    reader->row_count = header.row_count;
+    reader->data_offset = header.data_offset;
+    return true;
+}
+
+static bool open_text(ResultReader *reader, const char *path) {
+    CsvFile *csv = csv_open(path);
+    char *fields[RESULT_MAX_COLUMNS];
+    int count;
+
+    if (csv == NULL) return false;
+    if (!csv_read_long_line(csv, &reader->line, &reader->line_capacity)) {
+        if (csv_error(csv) != NULL) fprintf(stderr, "Error: '%s': %s.\n", path, csv_error(csv));
+        else fprintf(stderr, "Error: '%s' is empty.\n", path);
+        csv_close(csv);
+        return false;
+    }
+
+    count = split_fields(reader->line, fields, RESULT_MAX_COLUMNS);
+    if (count > RESULT_MAX_COLUMNS) {
+        fprintf(stderr, "Error: '%s' has more than %d columns.\n", path, RESULT_MAX_COLUMNS);
+        csv_close(csv);
+        return false;
+    }
+    if (reader->line[0] == '\0') {
+        fprintf(stderr, "Error: '%s' has no header.\n", path);
+        csv_close(csv);
+        return false;
+    }
+    for (int c = 0; c < count; c++) snprintf(reader->names[c], RESULT_NAME_LENGTH, "%s", fields[c]);
+
+    reader->column_count = count;
+    reader->csv = csv;
+    return true;
+}
+
+ResultReader* result_reader_open(const char *path) {
+    ResultReader *reader = (ResultReader*)calloc(1, sizeof(ResultReader));
+    if (reader == NULL) return NULL;
+
+    if (open_binary(reader, path)) return reader;
+    if (!reader->failed && open_text(reader, path)) return reader;
+
+    free(reader->line);
+    free(reader);
+    return NULL;
+}
+
+int result_reader_column_count(const ResultReader *reader) {
+    return reader->column_count;
+}
+
+const char* result_reader_column_name(const ResultReader *reader, int column) {
+    return (column >= 0 && column < reader->column_count) ? reader->names[column] : "";
+}
+
+bool result_reader_is_binary(const ResultReader *reader) {
+    return reader->file != NULL;
+}
+
+// One large read per column; columns are contiguous, so each is a sequential stream
+static size_t read_binary(ResultReader *reader, double *values, size_t max_rows) {
+    uint64_t left = reader->row_count - reader->next_row;
+    size_t rows = left < max_rows ? (size_t)left : max_rows;
+
+    for (int c = 0; c < reader->column_count && rows > 0; c++) {
+        off_t_64 offset = (off_t_64)(reader->data_offset +
+                                     ((uint64_t)c * reader->row_count + reader->next_row) * sizeof(double));
+        if (fseeko(reader->file, offset, SEEK_SET) != 0 ||
+            fread(&values[(size_t)c * max_rows], sizeof(double), rows, reader->file) != rows) {
+            snprintf(reader->error, sizeof(reader->error), "Truncated file or read error");
+            reader->failed = true;
+            return 0;
+        }
+    }
+    reader->next_row += rows;
+    return rows;
+}
+
+// Splits a line at every comma; empty fields are kept, so "1,,3" has three
+// fields. Returns the number of fields, or max_fields + 1 if there are more.
+static int split_fields(char *line, char *fields[], int max_fields) {
+    int count = 0;
+    char *start = line;
+
+    for (;;) {
+        char *end = strchr(start, ',');
+        if (count == max_fields) return max_fields + 1;
+        fields[count++] = start;
+        if (end == NULL) return count;
+        *end = '\0';
+        start = end + 1;
+    }
+}
+
+// Every row must have exactly the header's fields: a ragged row would shift
+// values into the wrong columns, so it stops the read instead
+static size_t read_text(ResultReader *reader, double *values, size_t max_rows) {
+    CsvFile *csv = reader->csv;
+    char *fields[RESULT_MAX_COLUMNS];
+    size_t rows = 0;
+
+    while (rows < max_rows && csv_read_long_line(csv, &reader->line, &reader->line_capacity)) {
+        if (reader->line[0] == '\0') continue; // Blank line
+
+        int count = split_fields(reader->line, fields, reader->column_count);
+        if (count != reader->column_count) {
+            snprintf(reader->error, sizeof(reader->error), "Line %lld has %s%d fields, the header has %d",
+                     csv->current_line_number, count > reader->column_count ? "more than " : "",
+                     count > reader->column_count ? reader->column_count : count, reader->column_count);
+            reader->failed = true;
+            return 0;
+        }
+        for (int c = 0; c < count; c++) {
+            char *end = NULL;
+            double value = strtod(fields[c], &end);
+            values[(size_t)c * max_rows + rows] = end != fields[c] ? value : NAN;
+        }
+        rows++;
+    }
+    if (rows < max_rows && csv_error(csv) != NULL) {
+        snprintf(reader->error, sizeof(reader->error), "%s", csv_error(csv));
+        reader->failed = true;
+        return 0;
+    }
+
+    reader->next_row += rows;
+    return rows;
+}
+
+size_t result_reader_read(ResultReader *reader, double *values, size_t max_rows) {
+    if (reader == NULL || values == NULL || max_rows == 0 || reader->failed) return 0;
+    return reader->file != NULL ? read_binary(reader, values, max_rows) : read_text(reader, values, max_rows);
+}
+
+bool result_reader_failed(const ResultReader *reader) {
+    return reader->failed;
+}
+
+const char* result_reader_error(const ResultReader *reader) {
+    return reader->failed ? reader->error : NULL;
+}
+
+void result_reader_close(ResultReader *reader) {
+    if (reader == NULL) return;
+    if (reader->file != NULL) fclose(reader->file);
+    if (reader->csv != NULL) csv_close(reader->csv);
+    free(reader->line);
+    free(reader);
+}
+
+// --- Writer ---
+
+#ifdef _WIN32
+
+static bool map_file(ResultWriter *writer, const char *path) {
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) return false;
+    writer->base = (unsigned char*)calloc(1, writer->size);
+    if (writer->base == NULL) {
+        fclose(writer->file);
+        return false;
+    }
+    return true;
+}
+
+#else
+
+// Reserves the blocks before mapping, so a full disk fails here and not as a
+// SIGBUS while the rows are written
+static bool map_file(ResultWriter *writer, const char *path) {
+    int error;
+
+    writer->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (writer->fd < 0) return false;
+
+    error = posix_fallocate(writer->fd, 0, (off_t)writer->size);
+    if (error == EINVAL || error == EOPNOTSUPP) error = ftruncate(writer->fd, (off_t)writer->size) == 0 ? 0 : errno;
+    if (error == 0) {
+        void *base = mmap(NULL, writer->size, PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+        if (base != MAP_FAILED) {
+            writer->base = (unsigned char*)base;
+            return true;
+        }
+        error = errno;
+    }
+
+    close(writer->fd);
+    errno = error;
+    return false;
+}
+
+#endif // _WIN32
+
+ResultWriter* result_writer_create(const char *path, const char *const names[], int column_count, uint64_t row_count) {
+    ResultWriter *writer;
+    ResultFileHeader header;
+    uint64_t names_end = sizeof(header) + (uint64_t)column_count * RESULT_NAME_LENGTH;
+
+    if (column_count < 1 || column_count > RESULT_MAX_COLUMNS) {
+        fprintf(stderr, "Error: A result file needs 1 to %d columns.\n", RESULT_MAX_COLUMNS);
+        return NULL;
+    }
+    if (row_count > (SIZE_MAX - names_end) / sizeof(double) / (uint64_t)column_count - RESULT_DATA_ALIGNMENT) {
+        fprintf(stderr, "Error: %llu rows do not fit in memory.\n", (unsigned long long)row_count);
+        return NULL;
+    }
+    writer = (ResultWriter*)calloc(1, sizeof(ResultWriter));
+    if (writer == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        return NULL;
+    }
+
+    writer->row_count = row_count;
+    writer->column_count = column_count;
+    writer->data_offset = (uint32_t)((names_end + RESULT_DATA_ALIGNMENT - 1) / RESULT_DATA_ALIGNMENT * RESULT_DATA_ALIGNMENT);
+    writer->size = (size_t)(writer->data_offset + (uint64_t)column_count * row_count * sizeof(double));
+    if (!map_file(writer, path)) {
+        perror("Error creating result file");
+        free(writer);
+        return NULL;
+    }
+
+    // The file starts zero-filled: only the header and names need writing
+    header.magic = RESULT_FILE_MAGIC;
+    header.version = RESULT_FILE_VERSION;
+    header.row_count = row_count;
+    header.column_count = (uint32_t)column_count;
+    header.data_offset = writer->data_offset;
+    memcpy(writer->base, &header, sizeof(header));
+    for (int c = 0; c < column_count; c++) {
+        strncpy((char*)writer->base + sizeof(header) + (size_t)c * RESULT_NAME_LENGTH, names[c], RESULT_NAME_LENGTH - 1);
+    }
+    return writer;
+}
+
+double* result_writer_column(ResultWriter *writer, int column) {
+    return (double*)(writer->base + writer->data_offset) + (size_t)column * writer->row_count;
+}
+
+bool result_writer_close(ResultWriter *writer) {
+    bool written;
+
+    if (writer == NULL) return true;
+#ifdef _WIN32
+    written = fwrite(writer->base, 1, writer->size, writer->file) == writer->size;
+    written = fclose(writer->file) == 0 && written;
+    free(writer->base);
+#else
+    written = munmap(writer->base, writer->size) == 0;
+    written = close(writer->fd) == 0 && written;
+#endif
+    if (!written) perror("Error writing result file");
+    free(writer);
+    return written;
+}
@@ -0,0 +1,112 @@
+#ifndef RESULT_FILE_H
+#define RESULT_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// --- Binary Result Format ---
+// A ResultFileHeader, then column_count names of RESULT_NAME_LENGTH bytes
+// (NUL padded), then from data_offset one array of row_count native-endian
+// doubles per column (column-major). Text result files are CSVs with a header.
+
+#define RESULT_FILE_MAGIC 0x53525656u // "VVRS" read as little-endian
+#define RESULT_FILE_VERSION 1
+#define RESULT_NAME_LENGTH 32
+#define RESULT_MAX_COLUMNS 64
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t row_count;
+    uint32_t column_count;
+    uint32_t data_offset;  // Byte offset of the first column array
+} ResultFileHeader;
+
+// Sequential reader over a binary or text result file (opaque)
+typedef struct ResultReader ResultReader;
+
+// Binary result file being written in place through a memory mapping (opaque)
+typedef struct ResultWriter ResultWriter;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Opens a result file; binary when it starts with RESULT_FILE_MAGIC, else CSV text
+ * @param path File to open
+ * @return New reader, or NULL on failure (an error is printed)
+ */
+ResultReader* result_reader_open(const char *path);
+
+/**
+ * @brief Number of columns in the file
+ */
+int result_reader_column_count(const ResultReader *reader);
+
+/**
+ * @brief Name of a column (from the binary header or the CSV header line)
+ */
+const char* result_reader_column_name(const ResultReader *reader, int column);
+
+/**
+ * @brief Whether the file uses the binary format
+ */
+bool result_reader_is_binary(const ResultReader *reader);
+
+/**
+ * @brief Reads the next rows into a column-major block: column c of row r goes to
+ * values[c * max_rows + r]. Empty or unparsable text fields read as NaN and
+ * blank lines are skipped; a text row whose field count differs from the
+ * header's is a read error.
+ * @param reader Reader to advance
+ * @param values Block of column_count * max_rows doubles
+ * @param max_rows Capacity of the block in rows
+ * @return Rows read, 0 at the end of the file or on a read error (see result_reader_failed)
+ */
+size_t result_reader_read(ResultReader *reader, double *values, size_t max_rows);
+
+/**
+ * @brief Whether a read failed (truncated binary file, ragged text row or I/O error)
+ */
+bool result_reader_failed(const ResultReader *reader);
+
+/**
+ * @brief Why a read failed, e.g. "Line 7 has 2 fields, the header has 3"
+ * @return Description, or NULL if no read failed
+ */
+const char* result_reader_error(const ResultReader *reader);
+
+/**
+ * @brief Closes the reader (NULL is allowed)
+ */
+void result_reader_close(ResultReader *reader);
+
+/**
+ * @brief Creates a binary result file for a known number of rows. The file is
+ * sized up front and mapped, so every value has a fixed address: rows can be
+ * written in any order, by several threads at once, without seeks or copies.
+ * Columns start on a cache line boundary.
+ * @param path File to create (replaced if it exists)
+ * @param names Column names (truncated to RESULT_NAME_LENGTH - 1 characters)
+ * @param column_count Number of columns (1 to RESULT_MAX_COLUMNS)
+ * @param row_count Number of rows
+ * @return New writer with every value 0, or NULL on failure (an error is printed)
+ */
+ResultWriter* result_writer_create(const char *path, const char *const names[], int column_count, uint64_t row_count);
+
+/**
+ * @brief The row_count doubles of a column, inside the mapped file
+ * @param writer Writer
+ * @param column Column index
+ * @return Column array, valid until result_writer_close
+ */
+double* result_writer_column(ResultWriter *writer, int column);
+
+/**
+ * @brief Unmaps and closes the file (NULL is allowed)
+ * @param writer Writer to close
+ * @return true if the file was written completely
+ */
+bool result_writer_close(ResultWriter *writer);
+
+#endif // RESULT_FILE_H
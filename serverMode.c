@@ -0,0 +1,790 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "serverMode.h"
+#include "serverProtocol.h"
+#include "vecvol.h"
+
+#ifdef _WIN32
+
+int run_server(const ServerOptions *options) {
+    (void)options;
+    fprintf(stderr, "Error: Server mode needs Unix domain sockets (not available on Windows).\n");
+    return 1;
+}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#define MAX_CONNECTIONS 256
+#define READ_CHUNK 65536
+#define DEFAULT_MAX_BATCH 4096
+#define MAX_READ_PER_ROUND (16 * READ_CHUNK) // Bytes taken from one client per poll round
+#define MAX_PENDING_OUTPUT (1 << 20)         // Unsent response bytes before a client is no longer read
+#define MAX_FRAME_BYTES (sizeof(VvRequestHeader) + VV_PROTO_MAX_PAYLOAD)
+
+// --- Data Structures ---
+
+// One client connection; slots are reused, generation tells reuses apart
+typedef struct {
+    int fd;
+    uint32_t generation;
+    unsigned char *in_buf;
+    size_t in_len, in_cap;
+    unsigned char *out_buf;
+    size_t out_len, out_cap, out_sent;
+    bool closing; // Close once the output buffer has been flushed
+} Connection;
+
+// Where to send the answer of a decoded request
+typedef struct {
+    size_t conn;
+    uint32_t generation;
+    uint32_t request_id;
+    uint64_t received_ns;
+} PendingRef;
+
+// Requests of one opcode waiting to be executed as a batch
+typedef struct {
+    PendingRef *refs;
+    unsigned char *payloads;
+    size_t payload_size;
+    size_t count, capacity;
+} OpQueue;
+
+// CSV runs take long, they are handed to a worker thread
+typedef struct CsvJob {
+    PendingRef ref;
+    VvCsvRunRequest request;
+    VvStatus status;
+    VvTestSummary summary;
+    uint64_t start_ns, end_ns;
+    struct CsvJob *next;
+} CsvJob;
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    CsvJob *pending_head, *pending_tail;
+    CsvJob *done_head;
+    bool stopping;
+    int wake_write_fd;
+} CsvWorker;
+
+typedef struct {
+    int listen_fd;
+    int wake_read_fd;
+    size_t max_batch;
+    Connection conns[MAX_CONNECTIONS];
+    OpQueue triple, cross_dot, contains;
+    VvContext *ctx;
+    double *scratch;
+    size_t scratch_cap;
+    uint8_t *flags;
+    size_t flags_cap;
+    CsvWorker worker;
+    VvStatsResponse stats;
+} Server;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+// --- Helper Prototypes ---
+static void handle_stop_signal(int signo);
+static uint64_t now_ns(void);
+static bool reserve(void **buffer, size_t *capacity, size_t needed, size_t element_size);
+static bool queue_push(OpQueue *queue, const PendingRef *ref, const void *payload);
+static void record_latency(Server *server, uint16_t opcode, uint64_t latency_ns);
+static void send_response(Server *server, const PendingRef *ref, uint16_t opcode, VvStatus status,
+                          const void *payload, uint32_t payload_length,
+                          uint64_t queue_ns, uint64_t service_ns, uint32_t batch_size);
+static void execute_triple(Server *server);
+static void execute_cross_dot(Server *server);
+static void execute_contains(Server *server);
+static void execute_all(Server *server);
+static void submit_csv_job(Server *server, const PendingRef *ref, const VvCsvRunRequest *request);
+static void collect_csv_jobs(Server *server);
+static void *csv_worker_main(void *arg);
+static void decode_frames(Server *server, size_t index);
+static void read_connection(Server *server, size_t index);
+static void flush_connection(Connection *conn);
+static void close_connection(Connection *conn);
+static void accept_connections(Server *server);
+static int open_listen_socket(const char *path);
+
+static void handle_stop_signal(int signo) {
+    (void)signo;
+    stop_requested = 1;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Grows a buffer geometrically so it holds at least `needed` elements
+static bool reserve(void **buffer, size_t *capacity, size_t needed, size_t element_size) {
+    if (needed <= *capacity) return true;
+
+    size_t new_capacity = *capacity ? *capacity : 64;
+    while (new_capacity < needed) new_capacity *= 2;
+
+    void *grown = realloc(*buffer, new_capacity * element_size);
+    if (grown == NULL) return false;
+
+    *buffer = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+static bool queue_push(OpQueue *queue, const PendingRef *ref, const void *payload) {
+    if (queue->count == queue->capacity) {
+        size_t refs_cap = queue->capacity;
+        size_t payloads_cap = queue->capacity;
+        if (!reserve((void**)&queue->refs, &refs_cap, queue->count + 1, sizeof(PendingRef))) return false;
+        if (!reserve((void**)&queue->payloads, &payloads_cap, queue->count + 1, queue->payload_size)) return false;
+        queue->capacity = refs_cap < payloads_cap ? refs_cap : payloads_cap;
+    }
+
+    queue->refs[queue->count] = *ref;
+    memcpy(queue->payloads + queue->count * queue->payload_size, payload, queue->payload_size);
+    queue->count++;
+    return true;
+}
+
+static void record_latency(Server *server, uint16_t opcode, uint64_t latency_ns) {
+    if (opcode == 0 || opcode > VV_OP_STATS) return;
+
+    VvOpStats *op = &server->stats.ops[opcode];
+    op->requests++;
+    op->total_latency_ns += latency_ns;
+    if (latency_ns > op->max_latency_ns) op->max_latency_ns = latency_ns;
+}
+
+// Appends a response frame to the connection's output buffer
+static void send_response(Server *server, const PendingRef *ref, uint16_t opcode, VvStatus status,
+                          const void *payload, uint32_t payload_length,
+                          uint64_t queue_ns, uint64_t service_ns, uint32_t batch_size) {
+    record_latency(server, opcode, queue_ns + service_ns);
+
+    Connection *conn = &server->conns[ref->conn];
+    if (conn->fd < 0 || conn->generation != ref->generation) return; // Client went away
+
+    VvResponseHeader header = {
+        .magic = VV_PROTO_MAGIC,
+        .opcode = opcode,
+        .status = (uint16_t)status,
+        .request_id = ref->request_id,
+        .payload_length = payload_length,
+        .queue_ns = queue_ns,
+        .service_ns = service_ns,
+        .batch_size = batch_size,
+        .reserved = 0
+    };
+
+    size_t needed = conn->out_len + sizeof(header) + payload_length;
+    if (!reserve((void**)&conn->out_buf, &conn->out_cap, needed, 1)) {
+        conn->closing = true;
+        return;
+    }
+
+    memcpy(conn->out_buf + conn->out_len, &header, sizeof(header));
+    conn->out_len += sizeof(header);
+    if (payload_length > 0) {
+        memcpy(conn->out_buf + conn->out_len, payload, payload_length);
+        conn->out_len += payload_length;
+    }
+}
+
+// --- Batch Execution ---
+
+static void execute_triple(Server *server) {
+    OpQueue *queue = &server->triple;
+    size_t n = queue->count;
+    if (n == 0) return;
+
+    const VvTripleRequest *requests = (const VvTripleRequest*)queue->payloads;
+    uint64_t start = now_ns();
+    VvStatus status = VV_ERR_OUT_OF_MEMORY;
+
+    if (reserve((void**)&server->scratch, &server->scratch_cap, 10 * n, sizeof(double))) {
+        double *a = server->scratch, *b = a + 3 * n, *c = b + 3 * n, *volumes = c + 3 * n;
+
+        for (size_t i = 0; i < n; i++) {
+            memcpy(&a[3 * i], requests[i].v1, sizeof(requests[i].v1));
+            memcpy(&b[3 * i], requests[i].v2, sizeof(requests[i].v2));
+            memcpy(&c[3 * i], requests[i].v3, sizeof(requests[i].v3));
+        }
+
+        // One kernel call for the whole batch, per-request k applied afterwards
+        status = vv_batch_volume(server->ctx, a, b, c, n, 1.0, volumes);
+    }
+    uint64_t service = now_ns() - start;
+
+    for (size_t i = 0; i < n; i++) {
+        const PendingRef *ref = &queue->refs[i];
+        VvStatus item_status = status;
+        VvTripleResponse response = { .volume = 0.0 };
+
+        if (item_status == VV_OK && requests[i].k == 0.0) item_status = VV_ERR_INVALID_ARGUMENT;
+        if (item_status == VV_OK) response.volume = server->scratch[9 * n + i] / requests[i].k;
+
+        send_response(server, ref, VV_OP_TRIPLE_PRODUCT, item_status,
+                      &response, item_status == VV_OK ? sizeof(response) : 0,
+                      start - ref->received_ns, service, (uint32_t)n);
+    }
+
+    server->stats.ops[VV_OP_TRIPLE_PRODUCT].batches++;
+    queue->count = 0;
+}
+
+static void execute_cross_dot(Server *server) {
+    OpQueue *queue = &server->cross_dot;
+    size_t n = queue->count;
+    if (n == 0) return;
+
+    const VvCrossDotRequest *requests = (const VvCrossDotRequest*)queue->payloads;
+    double *a = NULL, *b = NULL, *cross = NULL, *magnitudes = NULL, *dots = NULL;
+    uint64_t start = now_ns();
+    VvStatus status = VV_ERR_OUT_OF_MEMORY;
+
+    if (reserve((void**)&server->scratch, &server->scratch_cap, 11 * n, sizeof(double))) {
+        a = server->scratch;
+        b = a + 3 * n;
+        cross = b + 3 * n;
+        magnitudes = cross + 3 * n;
+        dots = magnitudes + n;
+
+        for (size_t i = 0; i < n; i++) {
+            memcpy(&a[3 * i], requests[i].a, sizeof(requests[i].a));
+            memcpy(&b[3 * i], requests[i].b, sizeof(requests[i].b));
+        }
+
+        status = vv_batch_cross_product(server->ctx, a, b, n, cross, magnitudes);
+        if (status == VV_OK) status = vv_batch_scalar_product(server->ctx, a, b, n, dots);
+    }
+    uint64_t service = now_ns() - start;
+
+    for (size_t i = 0; i < n; i++) {
+        const PendingRef *ref = &queue->refs[i];
+        VvCrossDotResponse response;
+
+        memset(&response, 0, sizeof(response));
+        if (status == VV_OK) {
+            memcpy(response.cross, &cross[3 * i], sizeof(response.cross));
+            response.magnitude = magnitudes[i];
+            response.dot = dots[i];
+        }
+
+        send_response(server, ref, VV_OP_CROSS_DOT, status,
+                      &response, status == VV_OK ? sizeof(response) : 0,
+                      start - ref->received_ns, service, (uint32_t)n);
+    }
+
+    server->stats.ops[VV_OP_CROSS_DOT].batches++;
+    queue->count = 0;
+}
+
+static void execute_contains(Server *server) {
+    OpQueue *queue = &server->contains;
+    size_t n = queue->count;
+    if (n == 0) return;
+
+    const VvContainsRequest *requests = (const VvContainsRequest*)queue->payloads;
+    uint64_t start = now_ns();
+    VvStatus status = VV_ERR_OUT_OF_MEMORY;
+
+    if (reserve((void**)&server->scratch, &server->scratch_cap, 12 * n, sizeof(double)) &&
+        reserve((void**)&server->flags, &server->flags_cap, n, sizeof(uint8_t))) {
+        double *shapes = server->scratch, *points = shapes + 9 * n;
+
+        for (size_t i = 0; i < n; i++) {
+            memcpy(&shapes[9 * i], requests[i].shape, sizeof(requests[i].shape));
+            memcpy(&points[3 * i], requests[i].point, sizeof(requests[i].point));
+        }
+
+        status = vv_batch_point_in_parallelepiped(server->ctx, shapes, points, n, server->flags);
+    }
+    uint64_t service = now_ns() - start;
+
+    for (size_t i = 0; i < n; i++) {
+        const PendingRef *ref = &queue->refs[i];
+        VvContainsResponse response = { .inside = 0, .reserved = 0 };
+
+        if (status == VV_OK) response.inside = server->flags[i];
+
+        send_response(server, ref, VV_OP_CONTAINS, status,
+                      &response, status == VV_OK ? sizeof(response) : 0,
+                      start - ref->received_ns, service, (uint32_t)n);
+    }
+
+    server->stats.ops[VV_OP_CONTAINS].batches++;
+    queue->count = 0;
+}
+
+static void execute_all(Server *server) {
+    execute_triple(server);
+    execute_cross_dot(server);
+    execute_contains(server);
+}
+
+// --- CSV Worker Thread ---
+
+static void submit_csv_job(Server *server, const PendingRef *ref, const VvCsvRunRequest *request) {
+    CsvJob *job = (CsvJob*)calloc(1, sizeof(CsvJob));
+    if (job == NULL) {
+        send_response(server, ref, VV_OP_CSV_RUN, VV_ERR_OUT_OF_MEMORY, NULL, 0, 0, 0, 1);
+        return;
+    }
+
+    job->ref = *ref;
+    job->request = *request;
+    job->request.path[VV_PROTO_PATH_LENGTH - 1] = '\0';
+
+    CsvWorker *worker = &server->worker;
+    pthread_mutex_lock(&worker->lock);
+    if (worker->pending_tail != NULL) {
+        worker->pending_tail->next = job;
+    } else {
+        worker->pending_head = job;
+    }
+    worker->pending_tail = job;
+    pthread_cond_signal(&worker->ready);
+    pthread_mutex_unlock(&worker->lock);
+}
+
+// Sends the answers of every finished CSV job
+static void collect_csv_jobs(Server *server) {
+    CsvWorker *worker = &server->worker;
+
+    pthread_mutex_lock(&worker->lock);
+    CsvJob *job = worker->done_head;
+    worker->done_head = NULL;
+    pthread_mutex_unlock(&worker->lock);
+
+    while (job != NULL) {
+        CsvJob *next = job->next;
+        VvCsvRunResponse response = { .summary = job->summary };
+
+        send_response(server, &job->ref, VV_OP_CSV_RUN, job->status,
+                      &response, job->status == VV_OK ? sizeof(response) : 0,
+                      job->start_ns - job->ref.received_ns, job->end_ns - job->start_ns, 1);
+        server->stats.ops[VV_OP_CSV_RUN].batches++;
+        free(job);
+        job = next;
+    }
+}
+
+static void *csv_worker_main(void *arg) {
+    CsvWorker *worker = (CsvWorker*)arg;
+    VvContext *ctx = NULL;
+
+    if (vv_context_create(&ctx) != VV_OK) ctx = NULL;
+
+    for (;;) {
+        pthread_mutex_lock(&worker->lock);
+        while (worker->pending_head == NULL && !worker->stopping) {
+            pthread_cond_wait(&worker->ready, &worker->lock);
+        }
+        if (worker->stopping) {
+            pthread_mutex_unlock(&worker->lock);
+            break;
+        }
+        CsvJob *job = worker->pending_head;
+        worker->pending_head = job->next;
+        if (worker->pending_head == NULL) worker->pending_tail = NULL;
+        pthread_mutex_unlock(&worker->lock);
+
+        job->start_ns = now_ns();
+        if (ctx == NULL) {
+            job->status = VV_ERR_OUT_OF_MEMORY;
+        } else if (job->request.kind == VV_CSV_RUN_VOLUME) {
+            job->status = vv_run_volume_tests(ctx, job->request.path, job->request.k, &job->summary);
+        } else if (job->request.kind == VV_CSV_RUN_CROSS) {
+            job->status = vv_run_cross_product_tests(ctx, job->request.path, &job->summary);
+        } else if (job->request.kind == VV_CSV_RUN_SCALAR) {
+            job->status = vv_run_scalar_product_tests(ctx, job->request.path, &job->summary);
+        } else {
+            job->status = VV_ERR_INVALID_ARGUMENT;
+        }
+        job->end_ns = now_ns();
+
+        pthread_mutex_lock(&worker->lock);
+        job->next = worker->done_head;
+        worker->done_head = job;
+        pthread_mutex_unlock(&worker->lock);
+
+        // Wake the poll loop; a full pipe already guarantees a wakeup
+        ssize_t ignored = write(worker->wake_write_fd, "x", 1);
+        (void)ignored;
+    }
+
+    vv_context_destroy(ctx);
+    return NULL;
+}
+
+// --- Connection Handling ---
+
+// Decodes every complete frame in the input buffer into the op queues
+static void decode_frames(Server *server, size_t index) {
+    Connection *conn = &server->conns[index];
+    size_t offset = 0;
+
+    while (!conn->closing && conn->in_len - offset >= sizeof(VvRequestHeader)) {
+        VvRequestHeader header;
+        memcpy(&header, conn->in_buf + offset, sizeof(header));
+
+        PendingRef ref = {
+            .conn = index,
+            .generation = conn->generation,
+            .request_id = header.request_id,
+            .received_ns = now_ns()
+        };
+
+        // A broken header means we lost the frame boundaries: answer and hang up
+        if (header.magic != VV_PROTO_MAGIC || header.payload_length > VV_PROTO_MAX_PAYLOAD) {
+            send_response(server, &ref, header.opcode, VV_ERR_FORMAT, NULL, 0, 0, 0, 0);
+            conn->closing = true;
+            break;
+        }
+        if (conn->in_len - offset < sizeof(header) + header.payload_length) break;
+
+        const unsigned char *payload = conn->in_buf + offset + sizeof(header);
+        uint32_t length = header.payload_length;
+        offset += sizeof(header) + length;
+
+        OpQueue *queue = NULL;
+        switch (header.opcode) {
+            case VV_OP_TRIPLE_PRODUCT: queue = &server->triple; break;
+            case VV_OP_CROSS_DOT:      queue = &server->cross_dot; break;
+            case VV_OP_CONTAINS:       queue = &server->contains; break;
+            case VV_OP_CSV_RUN: {
+                if (length != sizeof(VvCsvRunRequest)) break;
+                VvCsvRunRequest request;
+                memcpy(&request, payload, sizeof(request));
+                submit_csv_job(server, &ref, &request);
+                continue;
+            }
+            case VV_OP_STATS:
+                if (length != 0) break;
+                send_response(server, &ref, VV_OP_STATS, VV_OK,
+                              &server->stats, sizeof(server->stats), 0, 0, 1);
+                continue;
+            default:
+                break;
+        }
+
+        if (queue == NULL || length != queue->payload_size) {
+            send_response(server, &ref, header.opcode, VV_ERR_INVALID_ARGUMENT, NULL, 0, 0, 0, 0);
+            continue;
+        }
+        if (!queue_push(queue, &ref, payload)) {
+            send_response(server, &ref, header.opcode, VV_ERR_OUT_OF_MEMORY, NULL, 0, 0, 0, 0);
+            continue;
+        }
+        if (queue->count >= server->max_batch) execute_all(server);
+    }
+
+    // Keep the incomplete tail for the next read
+    memmove(conn->in_buf, conn->in_buf + offset, conn->in_len - offset);
+    conn->in_len -= offset;
+}
+
+// Frames are decoded after every chunk, so the buffer only ever holds one
+// partial frame plus a chunk; a client that keeps sending is read again in the
+// next round instead of being drained into memory
+static void read_connection(Server *server, size_t index) {
+    Connection *conn = &server->conns[index];
+    size_t round_bytes = 0;
+
+    while (!conn->closing && round_bytes < MAX_READ_PER_ROUND && conn->out_len < MAX_PENDING_OUTPUT) {
+        if (!reserve((void**)&conn->in_buf, &conn->in_cap, conn->in_len + READ_CHUNK, 1)) {
+            conn->closing = true;
+            return;
+        }
+
+        ssize_t received = read(conn->fd, conn->in_buf + conn->in_len, READ_CHUNK);
+        if (received > 0) {
+            conn->in_len += (size_t)received;
+            round_bytes += (size_t)received;
+            decode_frames(server, index);
+            // decode_frames rejects oversized headers, so only a frame that can never complete gets here
+            if (conn->in_len > MAX_FRAME_BYTES) conn->closing = true;
+            continue;
+        }
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+
+        conn->closing = true; // EOF or hard error; still answer what we already have
+        break;
+    }
+}
+
+static void flush_connection(Connection *conn) {
+    while (conn->out_sent < conn->out_len) {
+        ssize_t sent = send(conn->fd, conn->out_buf + conn->out_sent,
+                            conn->out_len - conn->out_sent, MSG_NOSIGNAL);
+        if (sent > 0) {
+            conn->out_sent += (size_t)sent;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+
+        conn->closing = true; // Peer is gone, drop what is left
+        conn->out_sent = conn->out_len;
+    }
+    conn->out_len = 0;
+    conn->out_sent = 0;
+}
+
+static void close_connection(Connection *conn) {
+    close(conn->fd);
+    conn->fd = -1;
+    conn->in_len = 0;
+    conn->out_len = 0;
+    conn->out_sent = 0;
+    conn->closing = false;
+}
+
+static void accept_connections(Server *server) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) return; // EAGAIN once the backlog is drained
+
+        size_t slot = 0;
+        while (slot < MAX_CONNECTIONS && server->conns[slot].fd >= 0) slot++;
+        if (slot == MAX_CONNECTIONS) {
+            close(fd);
+            continue;
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        server->conns[slot].fd = fd;
+        server->conns[slot].generation++;
+    }
+}
+
+static int open_listen_socket(const char *path) {
+    struct sockaddr_un address;
+    struct stat info;
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: Socket path too long (max %zu characters)\n", sizeof(address.sun_path) - 1);
+        return -1;
+    }
+
+    // Replace a stale socket from a previous run, but never a regular file
+    if (lstat(path, &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            fprintf(stderr, "Error: '%s' exists and is not a socket\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Error creating socket");
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    // Only the owner may connect: CSV_RUN opens files with the server's rights.
+    // The umask keeps the socket private from the moment bind creates it.
+    mode_t old_mask = umask(0077);
+    int bound = bind(fd, (struct sockaddr*)&address, sizeof(address));
+    umask(old_mask);
+
+    if (bound < 0 || chmod(path, 0600) < 0 || listen(fd, 128) < 0) {
+        perror("Error binding socket");
+        close(fd);
+        return -1;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// --- Server Entry Point ---
+
+int run_server(const ServerOptions *options) {
+    static Server server; // Too large for the stack (connection table)
+    struct pollfd fds[MAX_CONNECTIONS + 2];
+    size_t fd_conn[MAX_CONNECTIONS + 2];
+    int wake_pipe[2];
+
+    if (options == NULL || options->socket_path == NULL) {
+        fprintf(stderr, "Error: No socket path given.\n");
+        return 1;
+    }
+
+    memset(&server, 0, sizeof(server));
+    server.max_batch = options->max_batch ? options->max_batch : DEFAULT_MAX_BATCH;
+    server.triple.payload_size = sizeof(VvTripleRequest);
+    server.cross_dot.payload_size = sizeof(VvCrossDotRequest);
+    server.contains.payload_size = sizeof(VvContainsRequest);
+    for (size_t i = 0; i < MAX_CONNECTIONS; i++) server.conns[i].fd = -1;
+
+    if (vv_context_create(&server.ctx) != VV_OK) {
+        fprintf(stderr, "Error: Memory allocation failed.\n");
+        return 1;
+    }
+
+    server.listen_fd = open_listen_socket(options->socket_path);
+    if (server.listen_fd < 0) {
+        vv_context_destroy(server.ctx);
+        return 1;
+    }
+
+    if (pipe(wake_pipe) < 0) {
+        perror("Error creating wake pipe");
+        close(server.listen_fd);
+        vv_context_destroy(server.ctx);
+        return 1;
+    }
+    fcntl(wake_pipe[0], F_SETFL, fcntl(wake_pipe[0], F_GETFL) | O_NONBLOCK);
+    fcntl(wake_pipe[1], F_SETFL, fcntl(wake_pipe[1], F_GETFL) | O_NONBLOCK);
+    server.wake_read_fd = wake_pipe[0];
+    server.worker.wake_write_fd = wake_pipe[1];
+
+    pthread_mutex_init(&server.worker.lock, NULL);
+    pthread_cond_init(&server.worker.ready, NULL);
+    int error = pthread_create(&server.worker.thread, NULL, csv_worker_main, &server.worker);
+    if (error != 0) {
+        fprintf(stderr, "Error starting the CSV worker thread: %s\n", strerror(error));
+        pthread_mutex_destroy(&server.worker.lock);
+        pthread_cond_destroy(&server.worker.ready);
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+        close(server.listen_fd);
+        unlink(options->socket_path);
+        vv_context_destroy(server.ctx);
+        return 1;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    printf("Listening on %s (max batch %zu). Press Ctrl+C to stop.\n",
+           options->socket_path, server.max_batch);
+    fflush(stdout);
+
+    while (!stop_requested) {
+        nfds_t nfds = 0;
+        fds[nfds].fd = server.listen_fd;
+        fds[nfds++].events = POLLIN;
+        fds[nfds].fd = server.wake_read_fd;
+        fds[nfds++].events = POLLIN;
+
+        for (size_t i = 0; i < MAX_CONNECTIONS; i++) {
+            Connection *conn = &server.conns[i];
+            if (conn->fd < 0) continue;
+            fds[nfds].fd = conn->fd;
+            // A client that does not read its answers is not read either
+            bool readable = !conn->closing && conn->out_len < MAX_PENDING_OUTPUT;
+            fds[nfds].events = (short)((readable ? POLLIN : 0) | (conn->out_len > 0 ? POLLOUT : 0));
+            fd_conn[nfds++] = i;
+        }
+
+        if (poll(fds, nfds, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("Error in poll");
+            break;
+        }
+
+        // Everything readable in this round is decoded first, so concurrent
+        // small requests end up in the same batch
+        for (nfds_t i = 2; i < nfds; i++) {
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) read_connection(&server, fd_conn[i]);
+        }
+        execute_all(&server);
+
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(server.wake_read_fd, drain, sizeof(drain)) > 0) {}
+            collect_csv_jobs(&server);
+        }
+        if (fds[0].revents & POLLIN) accept_connections(&server);
+
+        for (size_t i = 0; i < MAX_CONNECTIONS; i++) {
+            Connection *conn = &server.conns[i];
+            if (conn->fd < 0) continue;
+            if (conn->out_len > 0) flush_connection(conn);
+            if (conn->closing && conn->out_len == 0) close_connection(conn);
+        }
+    }
+
+    // --- Shutdown ---
+    pthread_mutex_lock(&server.worker.lock);
+    server.worker.stopping = true;
+    pthread_cond_signal(&server.worker.ready);
+    pthread_mutex_unlock(&server.worker.lock);
+    pthread_join(server.worker.thread, NULL);
+
+    while (server.worker.pending_head != NULL) {
+        CsvJob *next = server.worker.pending_head->next;
+        free(server.worker.pending_head);
+        server.worker.pending_head = next;
+    }
+    while (server.worker.done_head != NULL) {
+        CsvJob *next = server.worker.done_head->next;
+        free(server.worker.done_head);
+        server.worker.done_head = next;
+    }
+
+    for (size_t i = 0; i < MAX_CONNECTIONS; i++) {
+        if (server.conns[i].fd >= 0) close(server.conns[i].fd);
+        free(server.conns[i].in_buf);
+        free(server.conns[i].out_buf);
+    }
+    OpQueue *queues[3] = { &server.triple, &server.cross_dot, &server.contains };
+    for (int i = 0; i < 3; i++) {
+        free(queues[i]->refs);
+        free(queues[i]->payloads);
+    }
+    free(server.scratch);
+    free(server.flags);
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    close(server.listen_fd);
+    unlink(options->socket_path);
+    pthread_mutex_destroy(&server.worker.lock);
+    pthread_cond_destroy(&server.worker.ready);
+    vv_context_destroy(server.ctx);
+
+    printf("\n--- Server Summary ---\n");
+    const char *names[] = { "", "Triple product", "Cross/dot", "Containment", "CSV run", "Stats" };
+    for (int op = VV_OP_TRIPLE_PRODUCT; op <= VV_OP_STATS; op++) {
+        const VvOpStats *s = &server.stats.ops[op];
+        if (s->requests == 0) continue;
+        printf("%-15s requests: %llu | batches: %llu | mean latency: %.1f us | max: %.1f us\n",
+               names[op], (unsigned long long)s->requests, (unsigned long long)s->batches,
+               (double)s->total_latency_ns / (double)s->requests / 1000.0,
+               (double)s->max_latency_ns / 1000.0);
+    }
+    return 0;
+}
+
+#endif // _WIN32
@@ -0,0 +1,21 @@
+#ifndef SERVER_MODE_H
+#define SERVER_MODE_H
+
+#include <stddef.h>
+
+// --- Server Configuration ---
+typedef struct {
+    const char *socket_path; // Unix domain socket to listen on
+    size_t max_batch;        // Max requests of one opcode executed as one batch
+} ServerOptions;
+
+/**
+ * @brief Runs the local request server until SIGINT/SIGTERM (see serverProtocol.h)
+ * Requests decoded in the same poll round are coalesced per opcode and executed
+ * with the libvecvol batch kernels; CSV runs go to a background worker thread.
+ * @param options Server configuration
+ * @return Process exit code (0 on clean shutdown)
+ */
+int run_server(const ServerOptions *options);
+
+#endif // SERVER_MODE_H
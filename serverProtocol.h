@@ -0,0 +1,113 @@
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+/*
+ * Wire format of the local server mode (calculator --serve <socket>).
+ *
+ * Every message is a fixed header followed by payload_length bytes of
+ * payload. Integers and doubles are in host byte order: the server only
+ * listens on a Unix domain socket, so both ends share the same machine.
+ * Responses echo the request_id, so clients may pipeline many requests on
+ * one connection; responses to different opcodes can come back out of order.
+ */
+
+#include <stdint.h>
+#include "vecvol.h"
+
+#define VV_PROTO_MAGIC 0x31505656u // "VVP1"
+#define VV_PROTO_MAX_PAYLOAD 4096
+#define VV_PROTO_PATH_LENGTH 256
+
+// --- Opcodes ---
+typedef enum {
+    VV_OP_TRIPLE_PRODUCT = 1, // VvTripleRequest  -> VvTripleResponse
+    VV_OP_CROSS_DOT      = 2, // VvCrossDotRequest -> VvCrossDotResponse
+    VV_OP_CONTAINS       = 3, // VvContainsRequest -> VvContainsResponse
+    VV_OP_CSV_RUN        = 4, // VvCsvRunRequest   -> VvCsvRunResponse
+    VV_OP_STATS          = 5  // (no payload)      -> VvStatsResponse
+} VvOpcode;
+
+// --- CSV Run Kinds ---
+typedef enum {
+    VV_CSV_RUN_VOLUME = 0,
+    VV_CSV_RUN_CROSS  = 1,
+    VV_CSV_RUN_SCALAR = 2
+} VvCsvRunKind;
+
+// --- Frame Headers ---
+typedef struct {
+    uint32_t magic;          // VV_PROTO_MAGIC
+    uint16_t opcode;         // VvOpcode
+    uint16_t flags;          // Reserved, must be 0
+    uint32_t request_id;     // Chosen by the client, echoed in the response
+    uint32_t payload_length; // Bytes following the header
+} VvRequestHeader;
+
+typedef struct {
+    uint32_t magic;          // VV_PROTO_MAGIC
+    uint16_t opcode;         // Opcode of the request
+    uint16_t status;         // VvStatus
+    uint32_t request_id;     // Copied from the request
+    uint32_t payload_length; // Bytes following the header (0 on error)
+    uint64_t queue_ns;       // Time from request decode to start of its batch
+    uint64_t service_ns;     // Time spent executing the batch it was part of
+    uint32_t batch_size;     // Number of requests coalesced into that batch
+    uint32_t reserved;
+} VvResponseHeader;
+
+// --- Payloads ---
+typedef struct {
+    double v1[3];
+    double v2[3];
+    double v3[3];
+    double k;                // 1 parallelepiped, 6 pyramid
+} VvTripleRequest;
+
+typedef struct {
+    double volume;
+} VvTripleResponse;
+
+typedef struct {
+    double a[3];
+    double b[3];
+} VvCrossDotRequest;
+
+typedef struct {
+    double cross[3];
+    double magnitude;
+    double dot;
+} VvCrossDotResponse;
+
+typedef struct {
+    double shape[9];         // Edge vectors V1, V2, V3
+    double point[3];
+} VvContainsRequest;
+
+typedef struct {
+    uint32_t inside;         // 1 inside, 0 outside
+    uint32_t reserved;
+} VvContainsResponse;
+
+typedef struct {
+    uint32_t kind;           // VvCsvRunKind
+    uint32_t reserved;
+    double k;                // Used by VV_CSV_RUN_VOLUME
+    char path[VV_PROTO_PATH_LENGTH]; // NUL terminated, resolved by the server
+} VvCsvRunRequest;
+
+typedef struct {
+    VvTestSummary summary;
+} VvCsvRunResponse;
+
+typedef struct {
+    uint64_t requests;       // Requests answered for this opcode
+    uint64_t batches;        // Batches executed for this opcode
+    uint64_t total_latency_ns; // Sum of queue + service time
+    uint64_t max_latency_ns;
+} VvOpStats;
+
+typedef struct {
+    VvOpStats ops[VV_OP_STATS + 1]; // Indexed by VvOpcode (index 0 unused)
+} VvStatsResponse;
+
+#endif // SERVER_PROTOCOL_H
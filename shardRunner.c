@@ -0,0 +1,322 @@
+#define _GNU_SOURCE // sched_setaffinity, MAP_ANONYMOUS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "shardRunner.h"
+#include "csvHandler.h"
+
+#ifdef _WIN32
+
+int run_sharded_tests(const char *csv_path, TestSuite suite, int shards, bool pin, bool collect_stats) {
+    (void)csv_path;
+    (void)suite;
+    (void)shards;
+    (void)pin;
+    (void)collect_stats;
+    fprintf(stderr, "Error: Sharded runs need fork() and are not available on Windows.\n");
+    return 1;
+}
+
+#else
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#define MAX_NUMA_NODES 64
+#define COPY_CHUNK (64 * 1024)
+
+// --- Data Structures ---
+
+// One worker's slot in the shared region
+typedef struct {
+    long long range_start, range_end; // Rows [start, end) of the file
+    RunCounters start;                // Counts before range_start (test numbering)
+    RunCounters counters;             // Written by the worker
+    ValueStats stats;                 // Written by the worker when collecting
+    int done;                         // Set by the worker after its last row
+} ShardSlot;
+
+// CPUs of each NUMA node, for pinning
+typedef struct {
+#ifdef __linux__
+    cpu_set_t cpus[MAX_NUMA_NODES];
+#endif
+    int count;
+} NumaNodes;
+
+// --- Helper Prototypes ---
+static double now_seconds(void);
+static uint64_t count_line_reads(const char *data, long long start, long long end);
+static long long next_line_start(const char *data, long long size, long long offset);
+static void find_numa_nodes(NumaNodes *nodes);
+static void run_worker(const char *csv_path, TestSuite suite, ShardSlot *slot, bool collect_stats,
+                       FILE *output, const NumaNodes *nodes, int index);
+static bool copy_output(FILE *output);
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Rows csv_read_line returns for [start, end): one per line, or more for a
+// line longer than the line buffer, which fgets hands over in pieces
+static uint64_t count_line_reads(const char *data, long long start, long long end) {
+    const long long piece = MAX_LINE_LENGTH - 1;
+    uint64_t rows = 0;
+
+    while (start < end) {
+        const char *newline = (const char*)memchr(data + start, '\n', (size_t)(end - start));
+        long long length = newline != NULL ? newline - (data + start) + 1 : end - start;
+        rows += (uint64_t)((length + piece - 1) / piece);
+        start += length;
+    }
+    return rows;
+}
+
+// First line start at or after offset (offset > 0)
+static long long next_line_start(const char *data, long long size, long long offset) {
+    const char *newline;
+
+    if (offset >= size) return size;
+    if (data[offset - 1] == '\n') return offset;
+    newline = (const char*)memchr(data + offset, '\n', (size_t)(size - offset));
+    return newline != NULL ? newline - data + 1 : size;
+}
+
+// Reads /sys/devices/system/node/nodeN/cpulist ("0-3,8-11") for every node
+static void find_numa_nodes(NumaNodes *nodes) {
+    nodes->count = 0;
+#ifdef __linux__
+    for (int node = 0; node < MAX_NUMA_NODES; node++) {
+        char path[64], list[1024];
+        char *cursor;
+        FILE *file;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        file = fopen(path, "r");
+        if (file == NULL) break;
+        if (fgets(list, sizeof(list), file) == NULL) list[0] = '\0';
+        fclose(file);
+
+        CPU_ZERO(&nodes->cpus[node]);
+        cursor = list;
+        while (*cursor >= '0' && *cursor <= '9') {
+            long first = strtol(cursor, &cursor, 10), last = first;
+            if (*cursor == '-') last = strtol(cursor + 1, &cursor, 10);
+            for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) CPU_SET((int)cpu, &nodes->cpus[node]);
+            if (*cursor == ',') cursor++;
+        }
+        nodes->count++;
+    }
+#endif
+}
+
+// Child process: runs the range of one slot, printing its rows into output
+static void run_worker(const char *csv_path, TestSuite suite, ShardSlot *slot, bool collect_stats,
+                       FILE *output, const NumaNodes *nodes, int index) {
+    RunOptions options = { .checkpoint_path = NULL };
+    CsvFile *csv;
+
+#ifdef __linux__
+    // Before the first allocation, so the worker's memory is local to its node
+    if (nodes->count > 1) sched_setaffinity(0, sizeof(cpu_set_t), &nodes->cpus[index % nodes->count]);
+#else
+    (void)nodes;
+    (void)index;
+#endif
+
+    if (dup2(fileno(output), STDOUT_FILENO) < 0) _exit(1);
+    csv = csv_open(csv_path);
+    if (csv == NULL) _exit(1);
+
+    options.range_start = slot->range_start;
+    options.range_end = slot->range_end;
+    options.start = &slot->start;
+    options.counters = &slot->counters;
+    options.quiet = RUN_QUIET_BANNER | RUN_QUIET_SUMMARY;
+    options.stats = collect_stats ? &slot->stats : NULL;
+    if (!run_test_suite(csv, suite, &options)) _exit(1);
+
+    csv_close(csv);
+    fflush(stdout);
+    slot->done = 1;
+    _exit(0);
+}
+
+static bool copy_output(FILE *output) {
+    char buffer[COPY_CHUNK];
+    size_t length;
+
+    rewind(output);
+    while ((length = fread(buffer, 1, sizeof(buffer), output)) > 0) {
+        if (fwrite(buffer, 1, length, stdout) != length) return false;
+    }
+    return !ferror(output);
+}
+
+// --- Coordinator ---
+
+int run_sharded_tests(const char *csv_path, TestSuite suite, int shards, bool pin, bool collect_stats) {
+    RunOptions options = { .checkpoint_path = NULL };
+    RunCounters probe = { UINT64_MAX, 0, 0, 0, 0, 0 }, merged = { 0, 0, 0, 0, 0, 0 };
+    FILE *outputs[MAX_SHARDS] = { NULL };
+    pid_t workers[MAX_SHARDS];
+    NumaNodes nodes;
+    ShardSlot *slots;
+    ValueStats *merged_stats = NULL;
+    CsvFile *csv;
+    struct stat info;
+    long long header_end;
+    char *data;
+    int fd, exit_code = 0;
+
+    if (shards == SHARDS_PER_CPU) shards = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (shards < 1) shards = 1;
+    if (shards > MAX_SHARDS) shards = MAX_SHARDS;
+
+    csv = csv_open(csv_path);
+    if (csv == NULL) return 1;
+    if (csv->decoder != NULL) {
+        fprintf(stderr, "Error: Sharded runs split the file by byte offsets and need an uncompressed file.\n");
+        csv_close(csv);
+        return 1;
+    }
+    csv_read_line(csv);
+    header_end = csv_tell(csv).offset;
+
+    fd = open(csv_path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &info) != 0 || header_end < 0) {
+        perror("Error opening file");
+        if (fd >= 0) close(fd);
+        csv_close(csv);
+        return 1;
+    }
+
+    // The banner comes from the runner itself; an empty range at the end of the
+    // file also checks the header before any worker starts
+    options.range_start = options.range_end = (long long)info.st_size;
+    options.counters = &probe;
+    options.quiet = RUN_QUIET_SUMMARY;
+    run_test_suite(csv, suite, &options);
+    if (probe.test_count == UINT64_MAX || info.st_size == 0) {
+        close(fd);
+        csv_close(csv);
+        return 1;
+    }
+
+    data = (char*)mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    slots = (ShardSlot*)mmap(NULL, (size_t)shards * sizeof(ShardSlot), PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    close(fd);
+    if (data == MAP_FAILED || slots == MAP_FAILED) {
+        perror("Error mapping memory");
+        if (data != MAP_FAILED) munmap(data, (size_t)info.st_size);
+        if (slots != MAP_FAILED) munmap(slots, (size_t)shards * sizeof(ShardSlot));
+        csv_close(csv);
+        return 1;
+    }
+
+    // Equal byte ranges, moved forward to line starts; row counts give each
+    // shard the test number it starts at
+    double start_time = now_seconds();
+    long long body = (long long)info.st_size - header_end, previous = header_end;
+    uint64_t tests_before = 0;
+    for (int i = 0; i < shards; i++) {
+        long long end = i + 1 == shards ? (long long)info.st_size
+                                        : next_line_start(data, info.st_size, header_end + body * (i + 1) / shards);
+        memset(&slots[i], 0, sizeof(ShardSlot));
+        slots[i].range_start = previous;
+        slots[i].range_end = end > previous ? end : previous;
+        slots[i].start.test_count = tests_before;
+        stats_init(&slots[i].stats, SKETCH_DEFAULT_ACCURACY);
+        tests_before += count_line_reads(data, slots[i].range_start, slots[i].range_end);
+        previous = slots[i].range_end;
+    }
+    munmap(data, (size_t)info.st_size);
+
+    find_numa_nodes(&nodes);
+    if (!pin) nodes.count = 0;
+
+    // Nothing buffered may be inherited, or it would be printed twice
+    fflush(stdout);
+    int started = 0;
+    for (; started < shards; started++) {
+        outputs[started] = tmpfile();
+        if (outputs[started] == NULL) break;
+        workers[started] = fork();
+        if (workers[started] < 0) {
+            fclose(outputs[started]);
+            outputs[started] = NULL;
+            break;
+        }
+        if (workers[started] == 0) run_worker(csv_path, suite, &slots[started], collect_stats, outputs[started], &nodes,
+                                                  started);
+    }
+    if (started < shards) {
+        perror("Error starting shard workers");
+        exit_code = 1;
+    }
+
+    for (int i = 0; i < started; i++) {
+        int status;
+        if (waitpid(workers[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !slots[i].done) {
+            fprintf(stderr, "Error: Shard %d (bytes %lld-%lld) failed.\n", i, slots[i].range_start, slots[i].range_end);
+            exit_code = 1;
+        }
+    }
+    double elapsed = now_seconds() - start_time;
+
+    // Rows in file order, then one summary over the merged counters
+    if (collect_stats && exit_code == 0) {
+        merged_stats = (ValueStats*)malloc(sizeof(ValueStats));
+        if (merged_stats == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed.\n");
+            exit_code = 1;
+        } else {
+            stats_init(merged_stats, SKETCH_DEFAULT_ACCURACY);
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        if (exit_code == 0 && !copy_output(outputs[i])) {
+            perror("Error copying shard output");
+            exit_code = 1;
+        }
+        fclose(outputs[i]);
+
+        merged.test_count += slots[i].counters.test_count - slots[i].start.test_count;
+        merged.passed_count += slots[i].counters.passed_count;
+        merged.failed_count += slots[i].counters.failed_count;
+        merged.error_count += slots[i].counters.error_count;
+        merged.exact_count += slots[i].counters.exact_count;
+        merged.float_count += slots[i].counters.float_count;
+        if (merged_stats != NULL) stats_merge(merged_stats, &slots[i].stats);
+    }
+
+    if (exit_code == 0) {
+        options.start = &merged;
+        options.counters = NULL;
+        options.quiet = RUN_QUIET_BANNER;
+        options.stats = merged_stats;
+        run_test_suite(csv, suite, &options);
+        fflush(stdout);
+        fprintf(stderr, "Shards: %d | NUMA nodes used: %d | Time: %.3f s (%.3e rows/s)\n", shards,
+                nodes.count > 1 ? (nodes.count < shards ? nodes.count : shards) : 1, elapsed,
+                elapsed > 0.0 ? (double)merged.test_count / elapsed : 0.0);
+    }
+
+    free(merged_stats);
+    munmap(slots, (size_t)shards * sizeof(ShardSlot));
+    csv_close(csv);
+    return exit_code;
+}
+
+#endif // _WIN32
@@ -0,0 +1,26 @@
+#ifndef SHARD_RUNNER_H
+#define SHARD_RUNNER_H
+
+#include <stdbool.h>
+#include "testerFile.h"
+
+#define SHARDS_PER_CPU (-1) // One shard per online CPU
+#define MAX_SHARDS 256
+
+/**
+ * @brief Runs a test suite over a CSV file in several worker processes.
+ * The rows after the header are split into byte ranges on line boundaries.
+ * Each forked worker runs the stock runner on its range and leaves its
+ * counters (and value summary) in a shared memory region. The coordinator
+ * prints the rows of every shard in file order and one merged summary, so
+ * stdout matches a single-process run; shard layout and timing go to stderr.
+ * @param csv_path Uncompressed CSV test file
+ * @param suite Suite to run
+ * @param shards Worker processes (at most MAX_SHARDS), or SHARDS_PER_CPU
+ * @param pin Spread the workers over the NUMA nodes, one node each in turn (Linux)
+ * @param collect_stats Also print the merged distribution of the computed values
+ * @return 0 on success, 1 on error
+ */
+int run_sharded_tests(const char *csv_path, TestSuite suite, int shards, bool pin, bool collect_stats);
+
+#endif // SHARD_RUNNER_H
@@ -0,0 +1,385 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "spatialIndex.h"
+
+#define LEAF_SIZE 4
+#define MAX_TRAVERSAL_DEPTH 128
+#define QUERY_CHUNK 4096
+
+// --- Data Structures ---
+
+// Shape prepared for repeated containment tests
+typedef struct {
+    double origin[3];
+    double bc[3], ca[3], ab[3]; // E2 x E3, E3 x E1, E1 x E2
+    double det;                 // E1 · (E2 x E3)
+    double lo[3], hi[3];        // Bounding box of the (tolerance widened) shape
+    uint32_t id;                // Index in the caller's shape array
+} ShapeTest;
+
+// Leaf when count > 0 (shapes[first .. first + count)), else children first, first + 1
+typedef struct {
+    double lo[3], hi[3];
+    uint32_t first;
+    uint32_t count;
+} BvhNode;
+
+struct SpatialIndex {
+    ShapeTest *shapes; // Reordered so every leaf covers a contiguous range
+    size_t shape_count;
+    BvhNode *nodes;
+    size_t node_count;
+    size_t depth;      // Levels below the root of the deepest leaf
+    double tolerance;
+};
+
+// Growable list of hits of one query chunk
+typedef struct {
+    uint32_t *ids;
+    size_t count, capacity;
+    bool failed;
+} HitBuffer;
+
+// Appends the ids of the shapes containing a point; returns false on allocation failure
+typedef bool (*CollectHits)(const void *source, const double point[3], HitBuffer *hits);
+
+typedef struct {
+    const Parallelepiped *shapes;
+    size_t count;
+    double tolerance;
+} BruteForceSource;
+
+// --- Helper Prototypes ---
+static void prepare_shape(const Parallelepiped *shape, uint32_t id, double tolerance, ShapeTest *out);
+static bool shape_contains(const ShapeTest *shape, const double point[3], double tolerance);
+static bool box_contains(const double lo[3], const double hi[3], const double point[3]);
+static bool push_hit(HitBuffer *hits, uint32_t id);
+static void build_node(SpatialIndex *index, size_t node, size_t start, size_t end, size_t level);
+static bool collect_bvh(const void *source, const double point[3], HitBuffer *hits);
+static bool collect_brute_force(const void *source, const double point[3], HitBuffer *hits);
+static bool run_query(const void *source, CollectHits collect, const PackedVector *points,
+                      size_t count, ContainmentResult *result);
+
+// Same cross products and determinant as pointInParallelepiped
+static void prepare_shape(const Parallelepiped *shape, uint32_t id, double tolerance, ShapeTest *out) {
+    vector e1 = unpackVector(shape->edges[0]);
+    vector e2 = unpackVector(shape->edges[1]);
+    vector e3 = unpackVector(shape->edges[2]);
+    vector bc = crossProduct(e2, e3);
+    vector ca = crossProduct(e3, e1);
+    vector ab = crossProduct(e1, e2);
+
+    out->id = id;
+    out->det = scalaricProduct(e1, bc);
+    for (int i = 0; i < 3; i++) {
+        out->origin[i] = shape->origin.direction[i];
+        out->bc[i] = bc.direction[i];
+        out->ca[i] = ca.direction[i];
+        out->ab[i] = ab.direction[i];
+        out->lo[i] = out->hi[i] = out->origin[i];
+    }
+
+    // Box over the 8 corners of the shape with coefficients in [-tol, 1 + tol]
+    double low = -tolerance, high = 1.0 + tolerance;
+    for (int corner = 0; corner < 8; corner++) {
+        double s[3] = { (corner & 1) ? high : low, (corner & 2) ? high : low, (corner & 4) ? high : low };
+        for (int i = 0; i < 3; i++) {
+            double value = out->origin[i] + s[0] * e1.direction[i] + s[1] * e2.direction[i] + s[2] * e3.direction[i];
+            if (corner == 0 || value < out->lo[i]) out->lo[i] = value;
+            if (corner == 0 || value > out->hi[i]) out->hi[i] = value;
+        }
+    }
+
+    // Pad for rounding so boundary points accepted by the coefficient test stay inside
+    for (int i = 0; i < 3; i++) {
+        double pad = 1e-9 * (out->hi[i] - out->lo[i] + fabs(out->origin[i])) + 1e-12;
+        out->lo[i] -= pad;
+        out->hi[i] += pad;
+    }
+}
+
+static bool box_contains(const double lo[3], const double hi[3], const double point[3]) {
+    return point[0] >= lo[0] && point[0] <= hi[0] &&
+           point[1] >= lo[1] && point[1] <= hi[1] &&
+           point[2] >= lo[2] && point[2] <= hi[2];
+}
+
+// Containment test of the index: the padded box rejects most points before
+// the coefficients are computed
+static bool shape_contains(const ShapeTest *shape, const double point[3], double tolerance) {
+    if (!box_contains(shape->lo, shape->hi, point)) return false;
+    if (fabs(shape->det) < 1e-12) return false;
+
+    double q[3] = { point[0] - shape->origin[0], point[1] - shape->origin[1], point[2] - shape->origin[2] };
+    double alpha = (q[0] * shape->bc[0] + q[1] * shape->bc[1] + q[2] * shape->bc[2]) / shape->det;
+    double beta  = (q[0] * shape->ca[0] + q[1] * shape->ca[1] + q[2] * shape->ca[2]) / shape->det;
+    double gamma = (q[0] * shape->ab[0] + q[1] * shape->ab[1] + q[2] * shape->ab[2]) / shape->det;
+    double low = -tolerance, high = 1.0 + tolerance;
+
+    return alpha >= low && alpha <= high &&
+           beta  >= low && beta  <= high &&
+           gamma >= low && gamma <= high;
+}
+
+static bool push_hit(HitBuffer *hits, uint32_t id) {
+    if (hits->count == hits->capacity) {
+        size_t new_capacity = hits->capacity ? hits->capacity * 2 : 256;
+        uint32_t *grown = realloc(hits->ids, new_capacity * sizeof(uint32_t));
+        if (grown == NULL) return false;
+        hits->ids = grown;
+        hits->capacity = new_capacity;
+    }
+    hits->ids[hits->count++] = id;
+    return true;
+}
+
+// --- BVH Construction ---
+
+static double centroid(const ShapeTest *shape, int axis) {
+    return 0.5 * (shape->lo[axis] + shape->hi[axis]);
+}
+
+static int compare_centroid_x(const void *lhs, const void *rhs) {
+    double a = centroid((const ShapeTest*)lhs, 0), b = centroid((const ShapeTest*)rhs, 0);
+    return (a > b) - (a < b);
+}
+
+static int compare_centroid_y(const void *lhs, const void *rhs) {
+    double a = centroid((const ShapeTest*)lhs, 1), b = centroid((const ShapeTest*)rhs, 1);
+    return (a > b) - (a < b);
+}
+
+static int compare_centroid_z(const void *lhs, const void *rhs) {
+    double a = centroid((const ShapeTest*)lhs, 2), b = centroid((const ShapeTest*)rhs, 2);
+    return (a > b) - (a < b);
+}
+
+static void build_node(SpatialIndex *index, size_t node, size_t start, size_t end, size_t level) {
+    BvhNode *n = &index->nodes[node];
+    double centroid_lo[3], centroid_hi[3];
+
+    if (level > index->depth) index->depth = level;
+
+    for (int i = 0; i < 3; i++) {
+        n->lo[i] = index->shapes[start].lo[i];
+        n->hi[i] = index->shapes[start].hi[i];
+        centroid_lo[i] = centroid_hi[i] = centroid(&index->shapes[start], i);
+    }
+    for (size_t s = start + 1; s < end; s++) {
+        for (int i = 0; i < 3; i++) {
+            double c = centroid(&index->shapes[s], i);
+            if (index->shapes[s].lo[i] < n->lo[i]) n->lo[i] = index->shapes[s].lo[i];
+            if (index->shapes[s].hi[i] > n->hi[i]) n->hi[i] = index->shapes[s].hi[i];
+            if (c < centroid_lo[i]) centroid_lo[i] = c;
+            if (c > centroid_hi[i]) centroid_hi[i] = c;
+        }
+    }
+
+    // Split at the median centroid of the widest axis
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (centroid_hi[i] - centroid_lo[i] > centroid_hi[axis] - centroid_lo[axis]) axis = i;
+    }
+
+    if (end - start <= LEAF_SIZE || centroid_hi[axis] == centroid_lo[axis]) {
+        n->first = (uint32_t)start;
+        n->count = (uint32_t)(end - start);
+        return;
+    }
+
+    static int (*const compare_axis[3])(const void*, const void*) = {
+        compare_centroid_x, compare_centroid_y, compare_centroid_z
+    };
+    size_t middle = start + (end - start) / 2;
+    qsort(&index->shapes[start], end - start, sizeof(ShapeTest), compare_axis[axis]);
+
+    size_t left = index->node_count;
+    index->node_count += 2;
+    n->first = (uint32_t)left;
+    n->count = 0;
+
+    build_node(index, left, start, middle, level + 1);
+    build_node(index, left + 1, middle, end, level + 1);
+}
+
+SpatialIndex* spatial_index_build(const Parallelepiped *shapes, size_t count, double tolerance) {
+    if (shapes == NULL || count == 0 || count > UINT32_MAX) return NULL;
+
+    SpatialIndex *index = (SpatialIndex*)calloc(1, sizeof(SpatialIndex));
+    if (index == NULL) return NULL;
+
+    index->shape_count = count;
+    index->tolerance = tolerance;
+    index->shapes = (ShapeTest*)malloc(count * sizeof(ShapeTest));
+    index->nodes = (BvhNode*)malloc((2 * count - 1) * sizeof(BvhNode));
+    if (index->shapes == NULL || index->nodes == NULL) {
+        spatial_index_free(index);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < count; i++) prepare_shape(&shapes[i], (uint32_t)i, tolerance, &index->shapes[i]);
+
+    index->node_count = 1;
+    build_node(index, 0, 0, count, 0);
+
+    // The traversal holds at most one pending sibling per level plus the
+    // current pair. Median splits keep the depth near log2(count), so this
+    // only fails for a corrupted build, never silently during a query.
+    if (index->depth + 1 > MAX_TRAVERSAL_DEPTH) {
+        spatial_index_free(index);
+        return NULL;
+    }
+    return index;
+}
+
+void spatial_index_free(SpatialIndex *index) {
+    if (index == NULL) return;
+    free(index->shapes);
+    free(index->nodes);
+    free(index);
+}
+
+// --- Queries ---
+
+static int compare_ids(const void *lhs, const void *rhs) {
+    uint32_t a = *(const uint32_t*)lhs, b = *(const uint32_t*)rhs;
+    return (a > b) - (a < b);
+}
+
+static bool collect_bvh(const void *source, const double point[3], HitBuffer *hits) {
+    const SpatialIndex *index = (const SpatialIndex*)source;
+    uint32_t stack[MAX_TRAVERSAL_DEPTH];
+    size_t depth = 0, first_hit = hits->count;
+
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const BvhNode *node = &index->nodes[stack[--depth]];
+        if (!box_contains(node->lo, node->hi, point)) continue;
+
+        if (node->count > 0) {
+            for (uint32_t s = node->first; s < node->first + node->count; s++) {
+                const ShapeTest *shape = &index->shapes[s];
+                if (shape_contains(shape, point, index->tolerance) && !push_hit(hits, shape->id)) return false;
+            }
+        } else { // Fits: spatial_index_build checked the tree depth
+            stack[depth++] = node->first + 1;
+            stack[depth++] = node->first;
+        }
+    }
+
+    // Leaves are visited in tree order; report ids ascending like the brute force
+    size_t found = hits->count - first_hit;
+    if (found > 1) qsort(&hits->ids[first_hit], found, sizeof(uint32_t), compare_ids);
+    return true;
+}
+
+// Independent of ShapeTest: no bounding box, coefficients from pointInParallelepiped
+static bool collect_brute_force(const void *source, const double point[3], HitBuffer *hits) {
+    const BruteForceSource *brute = (const BruteForceSource*)source;
+
+    for (size_t s = 0; s < brute->count; s++) {
+        const Parallelepiped *shape = &brute->shapes[s];
+        vector edges[3] = {
+            unpackVector(shape->edges[0]), unpackVector(shape->edges[1]), unpackVector(shape->edges[2])
+        };
+        vector relative;
+        for (int i = 0; i < 3; i++) relative.direction[i] = point[i] - shape->origin.direction[i];
+
+        if (pointInParallelepiped(edges, relative, brute->tolerance) && !push_hit(hits, (uint32_t)s)) return false;
+    }
+    return true;
+}
+
+// Runs the query in parallel chunks of points, then stitches the chunks into CSR
+static bool run_query(const void *source, CollectHits collect, const PackedVector *points,
+                      size_t count, ContainmentResult *result) {
+    size_t chunk_count = (count + QUERY_CHUNK - 1) / QUERY_CHUNK;
+    HitBuffer *chunks = (HitBuffer*)calloc(chunk_count ? chunk_count : 1, sizeof(HitBuffer));
+    bool failed = false;
+
+    memset(result, 0, sizeof(*result));
+    result->point_count = count;
+    result->row_offsets = (size_t*)malloc((count + 1) * sizeof(size_t));
+    if (chunks == NULL || result->row_offsets == NULL) {
+        free(chunks);
+        free_containment_result(result);
+        return false;
+    }
+
+    // Pass 1: every chunk collects its hits; row_offsets[i + 1] holds point i's count
+    #pragma omp parallel for schedule(dynamic)
+    for (long long c = 0; c < (long long)chunk_count; c++) {
+        size_t first = (size_t)c * QUERY_CHUNK;
+        size_t last = first + QUERY_CHUNK < count ? first + QUERY_CHUNK : count;
+
+        for (size_t i = first; i < last && !chunks[c].failed; i++) {
+            size_t before = chunks[c].count;
+            if (!collect(source, points[i].direction, &chunks[c])) chunks[c].failed = true;
+            result->row_offsets[i + 1] = chunks[c].count - before;
+        }
+    }
+
+    for (size_t c = 0; c < chunk_count; c++) {
+        if (chunks[c].failed) failed = true;
+    }
+
+    if (!failed) {
+        result->row_offsets[0] = 0;
+        for (size_t i = 0; i < count; i++) result->row_offsets[i + 1] += result->row_offsets[i];
+
+        size_t total = result->row_offsets[count];
+        result->shape_ids = (uint32_t*)malloc((total ? total : 1) * sizeof(uint32_t));
+        failed = result->shape_ids == NULL;
+    }
+
+    // Pass 2: copy each chunk's hits to its place in the CSR array
+    if (!failed) {
+        #pragma omp parallel for schedule(static)
+        for (long long c = 0; c < (long long)chunk_count; c++) {
+            if (chunks[c].count > 0) {
+                memcpy(&result->shape_ids[result->row_offsets[(size_t)c * QUERY_CHUNK]],
+                       chunks[c].ids, chunks[c].count * sizeof(uint32_t));
+            }
+        }
+    }
+
+    for (size_t c = 0; c < chunk_count; c++) free(chunks[c].ids);
+    free(chunks);
+
+    if (failed) {
+        free_containment_result(result);
+        return false;
+    }
+    return true;
+}
+
+bool spatial_index_query(const SpatialIndex *index, const PackedVector *points, size_t count,
+                         ContainmentResult *result) {
+    if (index == NULL || (points == NULL && count > 0) || result == NULL) return false;
+    return run_query(index, collect_bvh, points, count, result);
+}
+
+bool spatial_brute_force_query(const Parallelepiped *shapes, size_t shape_count, double tolerance,
+                               const PackedVector *points, size_t count, ContainmentResult *result) {
+    if (shapes == NULL || shape_count > UINT32_MAX || (points == NULL && count > 0) || result == NULL) return false;
+
+    BruteForceSource source = { shapes, shape_count, tolerance };
+    return run_query(&source, collect_brute_force, points, count, result);
+}
+
+bool containment_results_equal(const ContainmentResult *a, const ContainmentResult *b) {
+    if (a->point_count != b->point_count) return false;
+    if (memcmp(a->row_offsets, b->row_offsets, (a->point_count + 1) * sizeof(size_t)) != 0) return false;
+    return memcmp(a->shape_ids, b->shape_ids, a->row_offsets[a->point_count] * sizeof(uint32_t)) == 0;
+}
+
+void free_containment_result(ContainmentResult *result) {
+    if (result == NULL) return;
+    free(result->row_offsets);
+    free(result->shape_ids);
+    result->row_offsets = NULL;
+    result->shape_ids = NULL;
+    result->point_count = 0;
+}
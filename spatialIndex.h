@@ -0,0 +1,74 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "mathUtil.h"
+
+// --- Data Structures ---
+
+// A parallelepiped placed in space: origin + a*E1 + b*E2 + c*E3, a,b,c in [0,1]
+typedef struct {
+    PackedVector origin;
+    PackedVector edges[3];
+} Parallelepiped;
+
+// Containment results in CSR form: the shapes containing point i are
+// shape_ids[row_offsets[i]] ... shape_ids[row_offsets[i + 1] - 1], ascending.
+typedef struct {
+    size_t *row_offsets;  // point_count + 1 entries
+    uint32_t *shape_ids;  // row_offsets[point_count] entries
+    size_t point_count;
+} ContainmentResult;
+
+// Bounding-volume hierarchy over the shapes' bounding boxes (opaque)
+typedef struct SpatialIndex SpatialIndex;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Builds a BVH over the axis-aligned bounding boxes of the shapes
+ * @param shapes Shapes to index (copied, the caller keeps ownership)
+ * @param count Number of shapes (at most UINT32_MAX)
+ * @param tolerance Slack on each coefficient, as in pointInParallelepiped
+ * @return New index, or NULL on allocation failure or if the tree is deeper
+ * than the query traversal supports
+ */
+SpatialIndex* spatial_index_build(const Parallelepiped *shapes, size_t count, double tolerance);
+
+/**
+ * @brief Frees an index built by spatial_index_build (NULL is allowed)
+ */
+void spatial_index_free(SpatialIndex *index);
+
+/**
+ * @brief Finds every shape containing each point of a batch (parallel with OpenMP)
+ * @param index Index to query
+ * @param points Points to test
+ * @param count Number of points
+ * @param result Receives the CSR result (free with free_containment_result)
+ * @return true on success, false on allocation failure
+ */
+bool spatial_index_query(const SpatialIndex *index, const PackedVector *points, size_t count,
+                         ContainmentResult *result);
+
+/**
+ * @brief Reference implementation: tests every point against every shape.
+ * Uses pointInParallelepiped directly, without the index's bounding boxes, so
+ * comparing against it also checks the box and coefficient tests of the index.
+ */
+bool spatial_brute_force_query(const Parallelepiped *shapes, size_t shape_count, double tolerance,
+                               const PackedVector *points, size_t count, ContainmentResult *result);
+
+/**
+ * @brief Checks two containment results for exact equality
+ */
+bool containment_results_equal(const ContainmentResult *a, const ContainmentResult *b);
+
+/**
+ * @brief Frees the arrays of a ContainmentResult
+ */
+void free_containment_result(ContainmentResult *result);
+
+#endif // SPATIAL_INDEX_H
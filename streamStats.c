@@ -0,0 +1,369 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "streamStats.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define STATS_PARALLEL_MIN 65536 // Values below which threads cost more than they save
+#define HISTOGRAM_BAR 40
+
+// --- Helper Prototypes ---
+static void moments_add(RunningMoments *moments, double value);
+static void moments_merge(RunningMoments *into, const RunningMoments *from);
+static int sketch_key(const QuantileSketch *sketch, double magnitude);
+static double sketch_value(const QuantileSketch *sketch, int key);
+static void store_shift(SketchStore *store, int new_offset);
+static void store_add(SketchStore *store, int key, uint64_t count);
+static void store_merge(SketchStore *into, const SketchStore *from);
+static int decade_index(double magnitude);
+static int thread_count(void);
+
+// --- Moments ---
+
+static void moments_add(RunningMoments *moments, double value) {
+    double delta = value - moments->mean;
+
+    moments->count++;
+    moments->mean += delta / (double)moments->count;
+    moments->m2 += delta * (value - moments->mean);
+    if (moments->count == 1 || value < moments->min) moments->min = value;
+    if (moments->count == 1 || value > moments->max) moments->max = value;
+}
+
+// Chan et al. pairwise update
+static void moments_merge(RunningMoments *into, const RunningMoments *from) {
+    if (from->count == 0) return;
+    if (into->count == 0) {
+        *into = *from;
+        return;
+    }
+
+    double count = (double)into->count + (double)from->count;
+    double delta = from->mean - into->mean;
+    into->mean += delta * (double)from->count / count;
+    into->m2 += from->m2 + delta * delta * (double)into->count * (double)from->count / count;
+    into->count += from->count;
+    if (from->min < into->min) into->min = from->min;
+    if (from->max > into->max) into->max = from->max;
+}
+
+// --- Sketch Stores ---
+
+// Bucket i holds magnitudes in (gamma^(i-1), gamma^i]
+static int sketch_key(const QuantileSketch *sketch, double magnitude) {
+    return (int)ceil(log(magnitude) * sketch->key_scale);
+}
+
+// Representative of a bucket: within relative_accuracy of everything in it
+static double sketch_value(const QuantileSketch *sketch, int key) {
+    return 2.0 * pow(sketch->gamma, (double)key) / (sketch->gamma + 1.0);
+}
+
+// Moves the window to start at new_offset; keys below it fold into its first bucket
+static void store_shift(SketchStore *store, int new_offset) {
+    int shift = new_offset - store->offset;
+
+    if (shift > 0) {
+        int dropped = shift < SKETCH_BUCKETS ? shift : SKETCH_BUCKETS;
+        uint64_t folded = 0;
+
+        for (int i = 0; i < dropped; i++) folded += store->counts[i];
+        memmove(store->counts, store->counts + dropped, (size_t)(SKETCH_BUCKETS - dropped) * sizeof(uint64_t));
+        memset(store->counts + (SKETCH_BUCKETS - dropped), 0, (size_t)dropped * sizeof(uint64_t));
+        store->counts[0] += folded;
+
+        if (store->min_key < new_offset) store->min_key = new_offset;
+        if (store->max_key < new_offset) store->max_key = new_offset;
+    } else if (shift < 0) {
+        // Only used when every occupied key still fits
+        memmove(store->counts - shift, store->counts, (size_t)(SKETCH_BUCKETS + shift) * sizeof(uint64_t));
+        memset(store->counts, 0, (size_t)(-shift) * sizeof(uint64_t));
+    }
+    store->offset = new_offset;
+}
+
+static void store_add(SketchStore *store, int key, uint64_t count) {
+    if (store->total == 0) {
+        memset(store->counts, 0, sizeof(store->counts));
+        store->offset = key - SKETCH_BUCKETS / 2;
+        store->min_key = store->max_key = key;
+    } else if (key > store->max_key) {
+        if (key >= store->offset + SKETCH_BUCKETS) store_shift(store, key - SKETCH_BUCKETS + 1);
+        store->max_key = key;
+    } else if (key < store->min_key) {
+        if (key < store->offset) {
+            int lowest = store->max_key - SKETCH_BUCKETS + 1;
+            store_shift(store, key > lowest ? key : lowest);
+            if (key < store->offset) key = store->offset; // Folded into the lowest bucket
+        }
+        if (key < store->min_key) store->min_key = key;
+    }
+
+    store->counts[key - store->offset] += count;
+    store->total += count;
+}
+
+static void store_merge(SketchStore *into, const SketchStore *from) {
+    if (from->total == 0) return;
+    for (int key = from->min_key; key <= from->max_key; key++) {
+        uint64_t count = from->counts[key - from->offset];
+        if (count > 0) store_add(into, key, count);
+    }
+}
+
+// Power of ten of a non-zero finite magnitude, as an index into ValueStats.decades
+static int decade_index(double magnitude) {
+    int decade = (int)floor(log10(magnitude)) + STATS_DECADE_OFFSET;
+    if (decade < 0) return 0;
+    return decade < STATS_DECADE_COUNT ? decade : STATS_DECADE_COUNT - 1;
+}
+
+static int thread_count(void) {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// --- Public Functions ---
+
+void stats_init(ValueStats *stats, double relative_accuracy) {
+    memset(stats, 0, sizeof(*stats));
+    if (!(relative_accuracy > 0.0 && relative_accuracy < 1.0)) relative_accuracy = SKETCH_DEFAULT_ACCURACY;
+    stats->sketch.relative_accuracy = relative_accuracy;
+    stats->sketch.gamma = (1.0 + relative_accuracy) / (1.0 - relative_accuracy);
+    stats->sketch.key_scale = 1.0 / log(stats->sketch.gamma);
+}
+
+void stats_add(ValueStats *stats, double value) {
+    if (!isfinite(value)) {
+        stats->non_finite++;
+        return;
+    }
+
+    moments_add(&stats->moments, value);
+    if (value > 0.0) {
+        store_add(&stats->sketch.positive, sketch_key(&stats->sketch, value), 1);
+        stats->decades[1][decade_index(value)]++;
+    } else if (value < 0.0) {
+        store_add(&stats->sketch.negative, sketch_key(&stats->sketch, -value), 1);
+        stats->decades[0][decade_index(-value)]++;
+    } else {
+        stats->sketch.zero_count++;
+    }
+}
+
+void stats_add_values(ValueStats *stats, const double *values, size_t count) {
+    int threads = count >= STATS_PARALLEL_MIN ? thread_count() : 1;
+    ValueStats *partials = threads > 1 ? (ValueStats*)malloc((size_t)threads * sizeof(ValueStats)) : NULL;
+
+    if (partials == NULL) {
+        for (size_t i = 0; i < count; i++) stats_add(stats, values[i]);
+        return;
+    }
+
+    // One contiguous chunk per thread, merged in chunk order so the result
+    // does not depend on scheduling
+    #pragma omp parallel for num_threads(threads) schedule(static, 1)
+    for (int t = 0; t < threads; t++) {
+        size_t begin = count * (size_t)t / (size_t)threads;
+        size_t end = count * (size_t)(t + 1) / (size_t)threads;
+
+        stats_init(&partials[t], stats->sketch.relative_accuracy);
+        for (size_t i = begin; i < end; i++) stats_add(&partials[t], values[i]);
+    }
+
+    for (int t = 0; t < threads; t++) stats_merge(stats, &partials[t]);
+    free(partials);
+}
+
+bool stats_merge(ValueStats *into, const ValueStats *from) {
+    if (into->sketch.relative_accuracy != from->sketch.relative_accuracy) return false;
+
+    moments_merge(&into->moments, &from->moments);
+    store_merge(&into->sketch.positive, &from->sketch.positive);
+    store_merge(&into->sketch.negative, &from->sketch.negative);
+    into->sketch.zero_count += from->sketch.zero_count;
+    into->non_finite += from->non_finite;
+    for (int sign = 0; sign < 2; sign++) {
+        for (int decade = 0; decade < STATS_DECADE_COUNT; decade++) {
+            into->decades[sign][decade] += from->decades[sign][decade];
+        }
+    }
+    return true;
+}
+
+double stats_variance(const ValueStats *stats) {
+    return stats->moments.count > 1 ? stats->moments.m2 / (double)(stats->moments.count - 1) : 0.0;
+}
+
+double stats_quantile(const ValueStats *stats, double q) {
+    const QuantileSketch *sketch = &stats->sketch;
+    const SketchStore *negative = &sketch->negative, *positive = &sketch->positive;
+    uint64_t total = negative->total + sketch->zero_count + positive->total;
+    double estimate = 0.0, rank, seen = 0.0;
+    bool found = false;
+
+    if (total == 0) return NAN;
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+    rank = q * (double)(total - 1);
+
+    // Ascending values: large negative magnitudes first, then zero, then positive
+    for (int key = negative->max_key; negative->total > 0 && key >= negative->min_key && !found; key--) {
+        seen += (double)negative->counts[key - negative->offset];
+        if (seen > rank) {
+            estimate = -sketch_value(sketch, key);
+            found = true;
+        }
+    }
+    if (!found) {
+        seen += (double)sketch->zero_count;
+        found = seen > rank; // estimate stays 0
+    }
+    for (int key = positive->min_key; positive->total > 0 && key <= positive->max_key && !found; key++) {
+        seen += (double)positive->counts[key - positive->offset];
+        if (seen > rank) {
+            estimate = sketch_value(sketch, key);
+            found = true;
+        }
+    }
+
+    // The extremes are known exactly
+    if (estimate < stats->moments.min) estimate = stats->moments.min;
+    if (estimate > stats->moments.max) estimate = stats->moments.max;
+    return estimate;
+}
+
+void stats_print(const char *label, const ValueStats *stats) {
+    static const double percentiles[] = { 0.01, 0.10, 0.50, 0.90, 0.99, 0.999 };
+    static const char *percentile_names[] = { "p1", "p10", "p50", "p90", "p99", "p99.9" };
+    const QuantileSketch *sketch = &stats->sketch;
+    const RunningMoments *moments = &stats->moments;
+    uint64_t largest = sketch->zero_count;
+
+    printf("\n--- %s Distribution ---\n", label);
+    printf("Values: %llu", (unsigned long long)moments->count);
+    if (stats->non_finite > 0) printf(" (+%llu NaN/infinite, not included)", (unsigned long long)stats->non_finite);
+    printf("\n");
+    if (moments->count == 0) return;
+
+    printf("Min: %.6g | Max: %.6g | Mean: %.6g | Std dev: %.6g\n", moments->min, moments->max, moments->mean,
+           sqrt(stats_variance(stats)));
+    printf("Percentiles (within %g%%):", 100.0 * sketch->relative_accuracy);
+    for (size_t p = 0; p < sizeof(percentiles) / sizeof(percentiles[0]); p++) {
+        printf(" %s %.6g%s", percentile_names[p], stats_quantile(stats, percentiles[p]),
+               p + 1 < sizeof(percentiles) / sizeof(percentiles[0]) ? " |" : "\n");
+    }
+
+    // The decade counts are exact, unlike the sketch buckets, whose ranges
+    // straddle the powers of ten
+    for (int sign = 0; sign < 2; sign++) {
+        for (int decade = 0; decade < STATS_DECADE_COUNT; decade++) {
+            if (stats->decades[sign][decade] > largest) largest = stats->decades[sign][decade];
+        }
+    }
+
+    printf("Histogram by power of ten:\n");
+    for (int row = 0; row < 2 * STATS_DECADE_COUNT + 1; row++) {
+        char label_text[48];
+        uint64_t count;
+
+        // Rows: negative decades (largest magnitude first), zero, positive decades
+        if (row < STATS_DECADE_COUNT) {
+            int decade = STATS_DECADE_COUNT - 1 - row;
+            count = stats->decades[0][decade];
+            snprintf(label_text, sizeof(label_text), "(-1e%+d, -1e%+d]", decade - STATS_DECADE_OFFSET + 1,
+                     decade - STATS_DECADE_OFFSET);
+        } else if (row == STATS_DECADE_COUNT) {
+            count = sketch->zero_count;
+            snprintf(label_text, sizeof(label_text), "0");
+        } else {
+            int decade = row - STATS_DECADE_COUNT - 1;
+            count = stats->decades[1][decade];
+            snprintf(label_text, sizeof(label_text), "[1e%+d, 1e%+d)", decade - STATS_DECADE_OFFSET,
+                     decade - STATS_DECADE_OFFSET + 1);
+        }
+        if (count == 0) continue;
+
+        int bar = (int)((double)count / (double)largest * HISTOGRAM_BAR + 0.5);
+        printf("  %-18s %14llu %7.3f%%  ", label_text, (unsigned long long)count,
+               100.0 * (double)count / (double)moments->count);
+        for (int i = 0; i < (bar > 0 ? bar : 1); i++) putchar('#');
+        printf("\n");
+    }
+}
+
+// --- Serialization ---
+
+void stats_write(FILE *file, const ValueStats *stats) {
+    const QuantileSketch *sketch = &stats->sketch;
+
+    fprintf(file, "stats_moments %llu %.17g %.17g %.17g %.17g %llu\n", (unsigned long long)stats->moments.count,
+            stats->moments.mean, stats->moments.m2, stats->moments.min, stats->moments.max,
+            (unsigned long long)stats->non_finite);
+    fprintf(file, "stats_sketch %.17g %llu\n", sketch->relative_accuracy, (unsigned long long)sketch->zero_count);
+    for (int sign = 0; sign < 2; sign++) {
+        const SketchStore *store = sign ? &sketch->positive : &sketch->negative;
+        for (int key = store->min_key; store->total > 0 && key <= store->max_key; key++) {
+            uint64_t count = store->counts[key - store->offset];
+            if (count > 0) fprintf(file, "stats_bucket %c %d %llu\n", sign ? '+' : '-', key, (unsigned long long)count);
+        }
+        for (int decade = 0; decade < STATS_DECADE_COUNT; decade++) {
+            uint64_t count = stats->decades[sign][decade];
+            if (count > 0) {
+                fprintf(file, "stats_decade %c %d %llu\n", sign ? '+' : '-', decade - STATS_DECADE_OFFSET,
+                        (unsigned long long)count);
+            }
+        }
+    }
+}
+
+bool stats_parse(ValueStats *stats, const char *key, const char *value) {
+    if (strcmp(key, "stats_moments") == 0) {
+        unsigned long long count, non_finite;
+        RunningMoments moments;
+        if (sscanf(value, "%llu %lg %lg %lg %lg %llu", &count, &moments.mean, &moments.m2, &moments.min,
+                   &moments.max, &non_finite) != 6) {
+            return false;
+        }
+        moments.count = count;
+        stats->moments = moments;
+        stats->non_finite = non_finite;
+        return true;
+    }
+    if (strcmp(key, "stats_sketch") == 0) {
+        double accuracy;
+        unsigned long long zero_count;
+        if (sscanf(value, "%lg %llu", &accuracy, &zero_count) != 2 ||
+            accuracy != stats->sketch.relative_accuracy) {
+            return false;
+        }
+        stats->sketch.zero_count = zero_count;
+        return true;
+    }
+    if (strcmp(key, "stats_bucket") == 0) {
+        char sign;
+        int bucket;
+        unsigned long long count;
+        if (sscanf(value, "%c %d %llu", &sign, &bucket, &count) != 3 || (sign != '+' && sign != '-')) return false;
+        store_add(sign == '+' ? &stats->sketch.positive : &stats->sketch.negative, bucket, count);
+        return true;
+    }
+    if (strcmp(key, "stats_decade") == 0) {
+        char sign;
+        int power;
+        unsigned long long count;
+        if (sscanf(value, "%c %d %llu", &sign, &power, &count) != 3 || (sign != '+' && sign != '-') ||
+            power < -STATS_DECADE_OFFSET || power >= STATS_DECADE_COUNT - STATS_DECADE_OFFSET) {
+            return false;
+        }
+        stats->decades[sign == '+' ? 1 : 0][power + STATS_DECADE_OFFSET] += count;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,125 @@
+#ifndef STREAM_STATS_H
+#define STREAM_STATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SKETCH_BUCKETS 2048            // Per sign; covers values spanning ~1e17 at 1% accuracy
+#define SKETCH_DEFAULT_ACCURACY 0.01   // Relative error of the quantiles
+#define STATS_DECADE_OFFSET 330        // log10 of finite doubles lies in [-324, 308]
+#define STATS_DECADE_COUNT 640
+
+// --- Data Structures ---
+
+// Welford running moments
+typedef struct {
+    uint64_t count;
+    double mean;
+    double m2;   // Sum of squared deviations from the mean
+    double min, max;
+} RunningMoments;
+
+// Bucket counts for keys [offset, offset + SKETCH_BUCKETS). When values spread
+// wider than that, the lowest buckets are folded together, so the upper
+// quantiles keep their accuracy.
+typedef struct {
+    uint64_t counts[SKETCH_BUCKETS];
+    uint64_t total;
+    int offset;
+    int min_key, max_key; // Occupied key range (valid when total > 0)
+} SketchStore;
+
+// Log-bucketed quantile sketch (DDSketch): bucket i holds magnitudes in
+// (gamma^(i-1), gamma^i], so every quantile is within relative_accuracy
+typedef struct {
+    double relative_accuracy;
+    double gamma;
+    double key_scale; // 1 / ln(gamma)
+    SketchStore positive, negative;
+    uint64_t zero_count;
+} QuantileSketch;
+
+// Constant-size summary of a stream of values; plain data, so it can live in
+// shared memory and be merged in any order
+typedef struct {
+    RunningMoments moments;
+    QuantileSketch sketch;
+    uint64_t non_finite; // NaN and infinite values (not in moments or sketch)
+    // Exact counts by power of ten, floor(log10(|value|)) + STATS_DECADE_OFFSET;
+    // [0] negative, [1] positive values (zeros are in sketch.zero_count)
+    uint64_t decades[2][STATS_DECADE_COUNT];
+} ValueStats;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Resets a summary
+ * @param stats Summary to initialize
+ * @param relative_accuracy Quantile accuracy (e.g. SKETCH_DEFAULT_ACCURACY), in (0, 1)
+ */
+void stats_init(ValueStats *stats, double relative_accuracy);
+
+/**
+ * @brief Adds one value
+ * @param stats Summary
+ * @param value Value (NaN and infinities are only counted)
+ */
+void stats_add(ValueStats *stats, double value);
+
+/**
+ * @brief Adds an array of values; large arrays are split across threads, each
+ * filling its own summary, and the partial summaries are merged in order
+ * @param stats Summary
+ * @param values Values
+ * @param count Number of values
+ */
+void stats_add_values(ValueStats *stats, const double *values, size_t count);
+
+/**
+ * @brief Adds the values of another summary, as if they had been added here
+ * @param into Summary to extend
+ * @param from Summary to add (unchanged)
+ * @return false if the sketches were built with different accuracies
+ */
+bool stats_merge(ValueStats *into, const ValueStats *from);
+
+/**
+ * @brief Sample variance (0 for fewer than two values)
+ */
+double stats_variance(const ValueStats *stats);
+
+/**
+ * @brief Estimates a quantile from the sketch
+ * @param stats Summary
+ * @param q Quantile in [0, 1] (0.5 = median)
+ * @return Estimate within the relative accuracy, NaN for an empty summary
+ */
+double stats_quantile(const ValueStats *stats, double q);
+
+/**
+ * @brief Prints count, min/max/mean/standard deviation, percentiles and an
+ * exact histogram by powers of ten
+ * @param label Name of the values, for the heading
+ * @param stats Summary
+ */
+void stats_print(const char *label, const ValueStats *stats);
+
+/**
+ * @brief Writes a summary as "stats_* ..." lines (for checkpoint files)
+ * @param file Output file
+ * @param stats Summary
+ */
+void stats_write(FILE *file, const ValueStats *stats);
+
+/**
+ * @brief Applies one line written by stats_write
+ * @param stats Summary to restore (stats_init'ed before the first line)
+ * @param key First word of the line
+ * @param value Rest of the line
+ * @return true if the key belongs to a summary and the value was valid
+ */
+bool stats_parse(ValueStats *stats, const char *key, const char *value);
+
+#endif // STREAM_STATS_H
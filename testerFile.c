@@ -1,23 +1,77 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
 #include <math.h> 
 #include "mathUtil.h"
 #include "csvHandler.h"
 #include "testerFile.h"
+#include "streamStats.h"
+#include "resultFile.h"
+#include "vectorExpr.h"
 
-// --- Define Test Case Struct ---
+#define DEFAULT_CHECKPOINT_INTERVAL 100000
+#define RESULT_BLOCK_ROWS 4096 // Rows parsed before a parallel compute pass
+#define EXPR_BLOCK_ROWS 4096   // Rows parsed before an expression batch
+#define CHECKPOINT_COUNTS 7    // Counts saved in a checkpoint (checkpoint_count_keys)
+
+// Columns written by write_test_results
+enum {
+    RESULT_VOLUME, RESULT_EXPECTED, RESULT_PASSED,
+    RESULT_CROSS_X, RESULT_CROSS_Y, RESULT_CROSS_Z, RESULT_CROSS_MAG, RESULT_PERPENDICULAR,
+    RESULT_DOT12, RESULT_DOT13, RESULT_DOT23, RESULT_PARSED,
+    RESULT_COLUMN_COUNT
+};
+
+// --- Data Structures ---
+
+// Identity of a run: a checkpoint only resumes the run that wrote it
 typedef struct {
-    vector v1;
-    vector v2;
-    vector v3;
-    double expected_volume;
-} TestCase;
+    const char *runner;
+    double k_value;
+    char header[MAX_LINE_LENGTH]; // Header line of the CSV file
+} RunIdentity;
+
+// Checkpoint keys of the read position and the RunCounters fields, in order
+static const char *const checkpoint_count_keys[CHECKPOINT_COUNTS] = {
+    "line", "tests", "passed", "failed", "errors", "exact", "float"
+};
 
 // --- Helper Prototypes ---
-static bool map_4_fields_to_vector(CsvFile *file, vector *v_out);
-static bool read_test_case_row(CsvFile *file, TestCase *test_case);
 static bool vectors_are_coplanar(vector v1, vector v2, vector v3, double tolerance);
+static bool prepare_test_file(CsvFile *csv, unsigned mask, char header[MAX_LINE_LENGTH]);
+static bool prints(const RunOptions *options, unsigned part);
+static bool start_run(CsvFile *csv, const RunOptions *options, const RunIdentity *identity, RunCounters *counters);
+static bool row_in_range(CsvFile *csv, const RunOptions *options);
+static void record_value(const RunOptions *options, double value);
+static void print_distribution(const RunOptions *options, const char *label);
+static bool parse_count(const char *text, uint64_t *count);
+static bool resume_run(CsvFile *csv, const RunOptions *options, const RunIdentity *identity, RunCounters *counters);
+static int checkpoint_interval(const RunOptions *options);
+static void checkpoint_run(CsvFile *csv, const RunOptions *options, const RunIdentity *identity,
+                           const RunCounters *counters);
+static bool finish_run(CsvFile *csv, const RunOptions *options, const RunCounters *counters);
+static bool compute_result_row(const TestCase *test, double k_value, bool has_v3, bool has_expected,
+                               double *columns[], size_t row);
+
+// Rewinds the file, maps its header and checks the runner's columns exist
+static bool prepare_test_file(CsvFile *csv, unsigned mask, char header[MAX_LINE_LENGTH]) {
+    csv_rewind(csv);
+    if (!csv_read_line(csv)) {
+        printf("ERROR: Cannot read CSV header\n");
+        if (csv_error(csv) != NULL) printf("ERROR: %s\n", csv_error(csv));
+        return false;
+    }
+
+    strcpy(header, csv->line_buffer); // Mapping splits the line in place
+    csv_map_header(csv);
+    if (!csv_has_columns(csv, mask)) {
+        printf("ERROR: CSV header is missing columns required by this test\n");
+        return false;
+    }
+    return true;
+}
 
 // Helper function to check if three vectors are coplanar
 static bool vectors_are_coplanar(vector v1, vector v2, vector v3, double tolerance) {
@@ -26,137 +80,312 @@ static bool vectors_are_coplanar(vector v1, vector v2, vector v3, double toleran
     return fabs(scalar_triple) < tolerance;
 }
 
-// Function to read all 13 fields of a single test case line
-static bool read_test_case_row(CsvFile *file, TestCase *test_case) {
-    char *field_str;
+// --- Partial Runs ---
 
-    // --- Read V1 (4 fields) ---
-    if (!map_4_fields_to_vector(file, &test_case->v1)) return false;
+// Whether a part of the report (RUN_QUIET_*) is printed
+static bool prints(const RunOptions *options, unsigned part) {
+    return options == NULL || (options->quiet & part) == 0;
+}
 
-    // --- Read V2 (4 fields) ---
-    if (!map_4_fields_to_vector(file, &test_case->v2)) return false;
+// Positions the file at the first row to run and loads the counts before it
+static bool start_run(CsvFile *csv, const RunOptions *options, const RunIdentity *identity, RunCounters *counters) {
+    if (options == NULL) return true;
+    if (options->start != NULL) *counters = *options->start;
 
-    // --- Read V3 (4 fields) ---
-    if (!map_4_fields_to_vector(file, &test_case->v3)) return false;
-    
-    // --- Read Expected Volume (1 field) ---
-    field_str = csv_get_field(file);
-    if (field_str == NULL) return false;
-    test_case->expected_volume = atof(field_str);
+    if (options->range_start > 0) {
+        CsvPosition position = { options->range_start, csv->current_line_number + (long long)counters->test_count };
+        if (!csv_seek(csv, &position)) {
+            printf("ERROR: Cannot seek to byte %lld of the CSV file\n", options->range_start);
+            return false;
+        }
+    }
+    return resume_run(csv, options, identity, counters);
+}
 
+// Ranged runs stop at the first row starting at or after range_end
+static bool row_in_range(CsvFile *csv, const RunOptions *options) {
+    return options == NULL || options->range_end <= 0 || csv_tell(csv).offset < options->range_end;
+}
+
+// --- Value Distributions ---
+
+static void record_value(const RunOptions *options, double value) {
+    if (options != NULL && options->stats != NULL) stats_add(options->stats, value);
+}
+
+static void print_distribution(const RunOptions *options, const char *label) {
+    if (options != NULL && options->stats != NULL) stats_print(label, options->stats);
+}
+
+// --- Checkpoints ---
+// A checkpoint is a small text file of "key value" lines: the run identity, the
+// position of the next unread row and the counters (and value summary) up to that row. It is
+// written to a temporary file and renamed, so an interrupted write leaves the
+// previous checkpoint intact.
+
+// Reads a whole non-negative decimal number (no sign, no trailing text)
+static bool parse_count(const char *text, uint64_t *count) {
+    char *end;
+    unsigned long long value;
+
+    if (*text < '0' || *text > '9') return false;
+    errno = 0;
+    value = strtoull(text, &end, 10);
+    if (errno != 0 || *end != '\0') return false;
+    *count = (uint64_t)value;
     return true;
 }
 
-// Helper function to map 4 sequential fields into one vector struct
-static bool map_4_fields_to_vector(CsvFile *file, vector *v_out) {
-    char *field_str;
-    if (!file || !v_out) return false;
+// Restores the counters and the read position when options ask to resume
+static bool resume_run(CsvFile *csv, const RunOptions *options, const RunIdentity *identity, RunCounters *counters) {
+    char line[MAX_LINE_LENGTH + 16];
+    char runner[MAX_LINE_LENGTH] = "", header[MAX_LINE_LENGTH] = "";
+    double k_value = 0.0;
+    CsvPosition position = { -1, -1 };
+    RunCounters saved = { 0, 0, 0, 0, 0, 0 };
+    uint64_t line_number = 0;
+    uint64_t *const counts[CHECKPOINT_COUNTS] = {
+        &line_number, &saved.test_count, &saved.passed_count, &saved.failed_count,
+        &saved.error_count, &saved.exact_count, &saved.float_count
+    };
+    unsigned counts_found = 0;
+    ValueStats *restored = NULL;
+    bool has_stats = false, stats_valid = true, counts_valid = true, ok = true;
+    FILE *file;
 
-    // 1. Read X, Y, Z components
-    for (int i = 0; i < 3; i++) {
-        field_str = csv_get_field(file);
-        if (field_str == NULL) return false;
-        v_out->direction[i] = atof(field_str);
+    if (options == NULL || options->checkpoint_path == NULL || !options->resume) return true;
+    file = fopen(options->checkpoint_path, "r");
+    if (file == NULL) {
+        printf("No checkpoint at '%s': starting from the first row.\n", options->checkpoint_path);
+        return true;
+    }
+    if (options->stats != NULL) {
+        restored = (ValueStats*)malloc(sizeof(ValueStats));
+        if (restored == NULL) {
+            printf("ERROR: Memory allocation failed\n");
+            fclose(file);
+            return false;
+        }
+        stats_init(restored, options->stats->sketch.relative_accuracy);
     }
-    
-    // 4. Read Magnitude
-    field_str = csv_get_field(file);
-    if (field_str == NULL) return false;
-    v_out->magnitude = atof(field_str);
 
-    return true;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char *value = strchr(line, ' ');
+        if (line[0] == '#' || value == NULL) continue;
+        *value++ = '\0';
+        value[strcspn(value, "\r\n")] = '\0';
+
+        if (strcmp(line, "runner") == 0) snprintf(runner, sizeof(runner), "%s", value);
+        else if (strcmp(line, "header") == 0) snprintf(header, sizeof(header), "%s", value);
+        else if (strcmp(line, "k") == 0) k_value = strtod(value, NULL);
+        else if (strcmp(line, "offset") == 0) position.offset = strtoll(value, NULL, 10);
+        else if (strncmp(line, "stats_", 6) == 0) {
+            has_stats = true;
+            if (restored != NULL && !stats_parse(restored, line, value)) stats_valid = false;
+        } else {
+            for (int i = 0; i < CHECKPOINT_COUNTS; i++) {
+                if (strcmp(line, checkpoint_count_keys[i]) != 0) continue;
+                if (parse_count(value, counts[i])) counts_found |= 1u << i;
+                else counts_valid = false;
+            }
+        }
+    }
+    fclose(file);
+    position.line_number = line_number <= LLONG_MAX ? (long long)line_number : -1;
+
+    if (strcmp(runner, identity->runner) != 0 || k_value != identity->k_value ||
+        strcmp(header, identity->header) != 0 || (restored != NULL && !has_stats)) {
+        printf("Checkpoint '%s' belongs to another run: starting from the first row.\n", options->checkpoint_path);
+    } else if (counts_found != (1u << CHECKPOINT_COUNTS) - 1 || !counts_valid || position.line_number < 1 ||
+               !stats_valid) {
+        printf("ERROR: Checkpoint '%s' is incomplete\n", options->checkpoint_path);
+        ok = false;
+    } else if (!csv_seek(csv, &position)) {
+        printf("ERROR: Cannot continue at line %lld of the CSV file\n", position.line_number + 1);
+        ok = false;
+    } else {
+        *counters = saved;
+        if (restored != NULL) *options->stats = *restored;
+        printf("Resuming after test %llu (line %lld) from checkpoint '%s'\n", (unsigned long long)saved.test_count,
+               position.line_number, options->checkpoint_path);
+    }
+
+    free(restored);
+    return ok;
+}
+
+// Rows between checkpoints, 0 when the run saves none
+static int checkpoint_interval(const RunOptions *options) {
+    if (options == NULL || options->checkpoint_path == NULL) return 0;
+    return options->checkpoint_interval > 0 ? options->checkpoint_interval : DEFAULT_CHECKPOINT_INTERVAL;
+}
+
+// Saves the position after the last processed row, every checkpoint_interval rows
+static void checkpoint_run(CsvFile *csv, const RunOptions *options, const RunIdentity *identity,
+                           const RunCounters *counters) {
+    int interval = checkpoint_interval(options);
+    char temp_path[1024];
+    CsvPosition position;
+    FILE *file;
+
+    if (interval == 0 || counters->test_count % interval != 0) return;
+
+    // Rows reported before the checkpoint must not be lost with the process
+    fflush(stdout);
+
+    position = csv_tell(csv);
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", options->checkpoint_path);
+    file = fopen(temp_path, "w");
+    if (file == NULL) {
+        perror("Error writing checkpoint");
+        return;
+    }
+
+    fprintf(file, "# vecvol test run checkpoint (calculator --run ... --resume)\n");
+    fprintf(file, "runner %s\n", identity->runner);
+    fprintf(file, "k %.17g\n", identity->k_value);
+    fprintf(file, "header %s\n", identity->header);
+    fprintf(file, "offset %lld\n", position.offset);
+    fprintf(file, "line %lld\n", position.line_number);
+    fprintf(file, "tests %llu\npassed %llu\nfailed %llu\nerrors %llu\nexact %llu\nfloat %llu\n",
+            (unsigned long long)counters->test_count, (unsigned long long)counters->passed_count,
+            (unsigned long long)counters->failed_count, (unsigned long long)counters->error_count,
+            (unsigned long long)counters->exact_count, (unsigned long long)counters->float_count);
+    if (options->stats != NULL) stats_write(file, options->stats);
+
+    if (fclose(file) != 0) {
+        perror("Error writing checkpoint");
+        remove(temp_path);
+        return;
+    }
+#ifdef _WIN32
+    remove(options->checkpoint_path); // rename does not replace files on Windows
+#endif
+    if (rename(temp_path, options->checkpoint_path) != 0) perror("Error writing checkpoint");
+}
+
+// Hands out the counts; a completed run leaves no checkpoint behind, so the next --resume starts over.
+// Returns false when reading stopped at an error: the checkpoint is kept to resume from.
+static bool finish_run(CsvFile *csv, const RunOptions *options, const RunCounters *counters) {
+    const char *error = csv_error(csv);
+
+    if (error != NULL) printf("ERROR: %s (stopped after test %llu)\n", error, (unsigned long long)counters->test_count);
+    if (options == NULL) return error == NULL;
+    if (options->counters != NULL) *options->counters = *counters;
+    if (options->checkpoint_path != NULL && error == NULL) remove(options->checkpoint_path);
+    return error == NULL;
 }
 
 // --- Test Runner Functions ---
 
-void run_volume_tests(CsvFile *csv, VolumeOperation operation, const char *test_name, double k_value) {
+bool run_volume_tests(CsvFile *csv, VolumeOperation operation, const char *test_name, double k_value,
+                      const RunOptions *options) {
     TestCase current_test;
-    int test_count = 0;
-    int passed_count = 0;
-    int failed_count = 0;
-    int error_count = 0;
+    RunCounters counters = { 0, 0, 0, 0, 0, 0 };
+    RunIdentity identity = { test_name, k_value, "" };
     
-    printf("\n=== Testing %s (k=%.1f) ===\n", test_name, k_value);
-    if (k_value == 6.0) {
-        printf("Note: CSV contains parallelepiped volumes. Expected = Parallelepiped / 6\n");
+    if (prints(options, RUN_QUIET_BANNER)) {
+        printf("\n=== Testing %s (k=%.1f) ===\n", test_name, k_value);
+        if (k_value == 6.0) {
+            printf("Note: CSV contains parallelepiped volumes. Expected = Parallelepiped / 6\n");
+        }
     }
 
-    // Rewind file and skip header
-    rewind(csv->file_ptr);
-    csv->current_line_number = 0;
-    if (!csv_read_line(csv)) {
-        printf("ERROR: Cannot read CSV header\n");
-        return;
-    }
+    // Only decode what the runner uses; the stock kernel ignores input magnitudes
+    unsigned mask = CSV_MASK_VECTORS | CSV_MASK_EXPECTED;
+    if (operation != volumeParallelepiped) mask |= CSV_MASK_MAGNITUDES;
+    if (!prepare_test_file(csv, mask, identity.header)) return false;
+    if (!start_run(csv, options, &identity, &counters)) return false;
 
-    while (csv_read_line(csv)) {
-        test_count++;
+    while (row_in_range(csv, options) && csv_read_line(csv)) {
+        counters.test_count++;
         
-        if (read_test_case_row(csv, &current_test)) {
-            vector vectors[3] = {current_test.v1, current_test.v2, current_test.v3};
-            double calculated_volume = operation(vectors, k_value);
+        if (csv_read_test_case_columns(csv, &current_test, mask)) {
+            // Integer rows take the exact path when the plain volume is requested
+            bool exact = current_test.integer_coordinates && operation == volumeParallelepiped;
+            double calculated_volume;
+
+            if (exact) {
+                calculated_volume = volumeParallelepipedExact(current_test.int_coordinates, k_value);
+                counters.exact_count++;
+            } else {
+                vector vectors[3] = {current_test.v1, current_test.v2, current_test.v3};
+                calculated_volume = operation(vectors, k_value);
+                counters.float_count++;
+            }
+            record_value(options, calculated_volume);
             
             // Adjust expected volume based on k value
             double expected_volume = current_test.expected_volume / k_value;
             
             // Validation: if expected volume is ~0, vectors should be coplanar
             if (fabs(expected_volume) < 0.001) {
-                if (!vectors_are_coplanar(current_test.v1, current_test.v2, current_test.v3, 0.001)) {
-                    printf("Test %d: WARNING - Expected volume ~0 but vectors not coplanar\n", test_count);
+                bool coplanar = exact ? calculated_volume == 0.0
+                                      : vectors_are_coplanar(current_test.v1, current_test.v2, current_test.v3, 0.001);
+                if (!coplanar) {
+                    printf("Test %llu: WARNING - Expected volume ~0 but vectors not coplanar\n",
+                           (unsigned long long)counters.test_count);
                 }
             }
             
             // Compare the result (0.1% tolerance)
             double tolerance = 0.001; 
             if (fabs(calculated_volume - expected_volume) < tolerance) {
-                printf("Test %d: PASS (Volume: %.3lf)\n", test_count, calculated_volume);
-                passed_count++;
+                printf("Test %llu: PASS (Volume: %.3lf)\n", (unsigned long long)counters.test_count, calculated_volume);
+                counters.passed_count++;
             } else {
-                printf("Test %d: FAIL! (Calculated: %.3lf, Expected: %.3lf, Diff: %.6lf)\n", 
-                       test_count, calculated_volume, expected_volume, 
+                printf("Test %llu: FAIL! (Calculated: %.3lf, Expected: %.3lf, Diff: %.6lf)\n", 
+                       (unsigned long long)counters.test_count, calculated_volume, expected_volume, 
                        fabs(calculated_volume - expected_volume));
-                failed_count++;
+                counters.failed_count++;
             }
         } else {
-            printf("Test %d: ERROR - Could not parse all 13 fields from the row.\n", test_count);
-            error_count++;
+            printf("Test %llu: ERROR - Could not parse the required fields from the row.\n",
+                   (unsigned long long)counters.test_count);
+            counters.error_count++;
         }
+        checkpoint_run(csv, options, &identity, &counters);
     }
+    bool complete = finish_run(csv, options, &counters);
+    if (!prints(options, RUN_QUIET_SUMMARY)) return complete;
     
     printf("\n--- %s Summary ---\n", test_name);
-    printf("Total Tests: %d | Passed: %d | Failed: %d | Errors: %d\n", 
-           test_count, passed_count, failed_count, error_count);
+    printf("Total Tests: %llu | Passed: %llu | Failed: %llu | Errors: %llu\n", 
+           (unsigned long long)counters.test_count, (unsigned long long)counters.passed_count,
+           (unsigned long long)counters.failed_count, (unsigned long long)counters.error_count);
+    printf("Exact integer path: %llu | Floating path: %llu\n", (unsigned long long)counters.exact_count,
+           (unsigned long long)counters.float_count);
     
-    if (passed_count == test_count && test_count > 0) {
+    if (counters.passed_count == counters.test_count && counters.test_count > 0) {
         printf("✓ All tests passed!\n");
-    } else if (failed_count > 0) {
+    } else if (counters.failed_count > 0) {
         printf("✗ Some tests failed. Review output above.\n");
     }
+    print_distribution(options, test_name);
     printf("\n");
+    return complete;
 }
 
-void run_scalar_product_tests(CsvFile *csv, BinaryVectorOperation operation) {
+bool run_scalar_product_tests(CsvFile *csv, BinaryVectorOperation operation, const RunOptions *options) {
     TestCase current_test;
-    int test_count = 0;
-    int error_count = 0;
+    RunCounters counters = { 0, 0, 0, 0, 0, 0 };
+    RunIdentity identity = { "Scalar Product", 0.0, "" };
     
-    printf("\n=== Testing Scalar Product ===\n");
+    if (prints(options, RUN_QUIET_BANNER)) printf("\n=== Testing Scalar Product ===\n");
 
-    // Rewind file and skip header
-    rewind(csv->file_ptr);
-    csv->current_line_number = 0;
-    if (!csv_read_line(csv)) {
-        printf("ERROR: Cannot read CSV header\n");
-        return;
-    }
+    // EXPECTED_VOLUME is never used here
+    unsigned mask = CSV_MASK_VECTORS;
+    if (operation != scalaricProduct) mask |= CSV_MASK_MAGNITUDES;
+    if (!prepare_test_file(csv, mask, identity.header)) return false;
+    if (!start_run(csv, options, &identity, &counters)) return false;
 
-    while (csv_read_line(csv)) {
-        test_count++;
+    while (row_in_range(csv, options) && csv_read_line(csv)) {
+        counters.test_count++;
         
-        if (read_test_case_row(csv, &current_test)) {
+        if (csv_read_test_case_columns(csv, &current_test, mask)) {
             // Test V1 · V2
             double result_v1_v2 = operation(current_test.v1, current_test.v2);
-            printf("Test %d: V1 · V2 = %.3lf\n", test_count, result_v1_v2);
+            printf("Test %llu: V1 · V2 = %.3lf\n", (unsigned long long)counters.test_count, result_v1_v2);
             
             // Test V1 · V3
             double result_v1_v3 = operation(current_test.v1, current_test.v3);
@@ -165,40 +394,50 @@ void run_scalar_product_tests(CsvFile *csv, BinaryVectorOperation operation) {
             // Test V2 · V3
             double result_v2_v3 = operation(current_test.v2, current_test.v3);
             printf("        V2 · V3 = %.3lf\n", result_v2_v3);
+
+            record_value(options, result_v1_v2);
+            record_value(options, result_v1_v3);
+            record_value(options, result_v2_v3);
         } else {
-            printf("Test %d: ERROR - Could not parse test case\n", test_count);
-            error_count++;
+            printf("Test %llu: ERROR - Could not parse test case\n", (unsigned long long)counters.test_count);
+            counters.error_count++;
         }
+        checkpoint_run(csv, options, &identity, &counters);
     }
+    bool complete = finish_run(csv, options, &counters);
     
+    if (!prints(options, RUN_QUIET_SUMMARY)) return complete;
     printf("\n--- Scalar Product Summary ---\n");
-    printf("Total test cases processed: %d | Errors: %d\n\n", test_count, error_count);
+    printf("Total test cases processed: %llu | Errors: %llu\n", (unsigned long long)counters.test_count,
+           (unsigned long long)counters.error_count);
+    print_distribution(options, "Scalar Product");
+    printf("\n");
+    return complete;
 }
 
-void run_cross_product_tests(CsvFile *csv, CrossOperation operation) {
+bool run_cross_product_tests(CsvFile *csv, CrossOperation operation, const RunOptions *options) {
     TestCase current_test;
-    int test_count = 0;
-    int error_count = 0;
+    RunCounters counters = { 0, 0, 0, 0, 0, 0 };
+    RunIdentity identity = { "Cross Product", 0.0, "" };
     
-    printf("\n=== Testing Cross Product ===\n");
+    if (prints(options, RUN_QUIET_BANNER)) printf("\n=== Testing Cross Product ===\n");
 
-    // Rewind file and skip header
-    rewind(csv->file_ptr);
-    csv->current_line_number = 0;
-    if (!csv_read_line(csv)) {
-        printf("ERROR: Cannot read CSV header\n");
-        return;
-    }
+    // Only V1 and V2 are used; the row is not scanned past V2_Z
+    unsigned mask = CSV_MASK_V1 | CSV_MASK_V2;
+    if (operation != crossProduct) mask |= CSV_MASK(CSV_COL_V1_MAG) | CSV_MASK(CSV_COL_V2_MAG);
+    if (!prepare_test_file(csv, mask, identity.header)) return false;
+    if (!start_run(csv, options, &identity, &counters)) return false;
 
-    while (csv_read_line(csv)) {
-        test_count++;
+    while (row_in_range(csv, options) && csv_read_line(csv)) {
+        counters.test_count++;
         
-        if (read_test_case_row(csv, &current_test)) {
+        if (csv_read_test_case_columns(csv, &current_test, mask)) {
             // Test V1 × V2
             vector result = operation(current_test.v1, current_test.v2);
-            printf("Test %d: V1 × V2 = [%.3lf, %.3lf, %.3lf] (mag: %.3lf)\n", 
-                   test_count, result.direction[0], result.direction[1], 
+            printf("Test %llu: V1 × V2 = [%.3lf, %.3lf, %.3lf] (mag: %.3lf)\n", 
+                   (unsigned long long)counters.test_count, result.direction[0], result.direction[1], 
                    result.direction[2], result.magnitude);
+            record_value(options, result.magnitude);
             
             // Verify perpendicularity (dot product should be ~0)
             double dot_v1 = scalaricProduct(result, current_test.v1);
@@ -209,11 +448,282 @@ void run_cross_product_tests(CsvFile *csv, CrossOperation operation) {
                        dot_v1, dot_v2);
             }
         } else {
-            printf("Test %d: ERROR - Could not parse test case\n", test_count);
-            error_count++;
+            printf("Test %llu: ERROR - Could not parse test case\n", (unsigned long long)counters.test_count);
+            counters.error_count++;
         }
+        checkpoint_run(csv, options, &identity, &counters);
     }
+    bool complete = finish_run(csv, options, &counters);
     
+    if (!prints(options, RUN_QUIET_SUMMARY)) return complete;
     printf("\n--- Cross Product Summary ---\n");
-    printf("Total test cases processed: %d | Errors: %d\n\n", test_count, error_count);
+    printf("Total test cases processed: %llu | Errors: %llu\n", (unsigned long long)counters.test_count,
+           (unsigned long long)counters.error_count);
+    print_distribution(options, "Cross Product Magnitude");
+    printf("\n");
+    return complete;
+}
+
+bool run_expression_tests(CsvFile *csv, const VectorExpr *expr, const RunOptions *options) {
+    RunCounters counters = { 0, 0, 0, 0, 0, 0 };
+    RunIdentity identity = { expr->text, 0.0, "" };
+    int interval = checkpoint_interval(options);
+    PackedVector *inputs;
+    bool *parsed;
+    double *values;
+    bool reading = true, evaluated = true;
+
+    if (prints(options, RUN_QUIET_BANNER)) printf("\n=== Evaluating %s ===\n", expr->text);
+
+    if (!prepare_test_file(csv, expr->mask, identity.header)) return false;
+    if (!start_run(csv, options, &identity, &counters)) return false;
+
+    inputs = (PackedVector*)calloc(3 * EXPR_BLOCK_ROWS, sizeof(PackedVector));
+    parsed = (bool*)malloc(EXPR_BLOCK_ROWS * sizeof(bool));
+    values = (double*)malloc(3 * EXPR_BLOCK_ROWS * sizeof(double));
+    if (inputs == NULL || parsed == NULL || values == NULL) {
+        printf("ERROR: Memory allocation failed\n");
+        free(inputs);
+        free(parsed);
+        free(values);
+        return false;
+    }
+    const PackedVector *const vectors[3] = { inputs, inputs + EXPR_BLOCK_ROWS, inputs + 2 * EXPR_BLOCK_ROWS };
+
+    // Rows are parsed a block at a time and the whole block is evaluated at
+    // once; a block ends at each checkpoint so the saved position stays exact
+    while (reading) {
+        uint64_t first_test = counters.test_count + 1;
+        size_t block_rows = 0;
+
+        while (block_rows < EXPR_BLOCK_ROWS) {
+            TestCase current_test;
+            if (!row_in_range(csv, options) || !csv_read_line(csv)) {
+                reading = false;
+                break;
+            }
+            counters.test_count++;
+
+            // A row that did not parse is evaluated on zeros and reported as an error
+            parsed[block_rows] = csv_read_test_case_columns(csv, &current_test, expr->mask);
+            for (int j = 0; j < 3; j++) {
+                bool ok = parsed[block_rows];
+                inputs[block_rows].direction[j] = ok ? current_test.v1.direction[j] : 0.0;
+                inputs[EXPR_BLOCK_ROWS + block_rows].direction[j] = ok ? current_test.v2.direction[j] : 0.0;
+                inputs[2 * EXPR_BLOCK_ROWS + block_rows].direction[j] = ok ? current_test.v3.direction[j] : 0.0;
+            }
+            block_rows++;
+            if (interval > 0 && counters.test_count % interval == 0) break;
+        }
+        if (block_rows == 0) break;
+
+        if (!expr_evaluate(expr, vectors, block_rows, values)) {
+            printf("ERROR: Memory allocation failed\n");
+            counters.test_count -= block_rows;
+            evaluated = false;
+            break;
+        }
+
+        for (size_t i = 0; i < block_rows; i++) {
+            const double *value = &values[i * (size_t)expr->dimension];
+            unsigned long long test_number = first_test + i;
+
+            if (!parsed[i]) {
+                printf("Test %llu: ERROR - Could not parse test case\n", test_number);
+                counters.error_count++;
+            } else if (expr->dimension == 1) {
+                printf("Test %llu: %s = %.3lf\n", test_number, expr->text, value[0]);
+                record_value(options, value[0]);
+            } else {
+                double magnitude = sqrt(value[0] * value[0] + value[1] * value[1] + value[2] * value[2]);
+                printf("Test %llu: %s = [%.3lf, %.3lf, %.3lf] (mag: %.3lf)\n", test_number, expr->text,
+                       value[0], value[1], value[2], magnitude);
+                record_value(options, magnitude);
+            }
+        }
+        checkpoint_run(csv, options, &identity, &counters);
+    }
+    free(inputs);
+    free(parsed);
+    free(values);
+    if (!evaluated) {
+        // Stopped early: the checkpoint (if any) stays for --resume
+        if (options != NULL && options->counters != NULL) *options->counters = counters;
+        return false;
+    }
+    bool complete = finish_run(csv, options, &counters);
+
+    if (!prints(options, RUN_QUIET_SUMMARY)) return complete;
+    printf("\n--- Expression Summary ---\n");
+    printf("Total test cases processed: %llu | Errors: %llu\n", (unsigned long long)counters.test_count,
+           (unsigned long long)counters.error_count);
+    print_distribution(options, expr->dimension == 1 ? expr->text : "Result Magnitude");
+    printf("\n");
+    return complete;
+}
+
+// --- Test Suites ---
+
+bool test_suite_from_name(const char *name, TestSuite *suite) {
+    static const struct { const char *name; TestSuite suite; } suites[] = {
+        { "parallelepiped", TEST_SUITE_PARALLELEPIPED },
+        { "pyramid",        TEST_SUITE_PYRAMID },
+        { "cross",          TEST_SUITE_CROSS_PRODUCT },
+        { "scalar",         TEST_SUITE_SCALAR_PRODUCT },
+    };
+
+    for (size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); i++) {
+        if (strcmp(name, suites[i].name) == 0) {
+            *suite = suites[i].suite;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool run_test_suite(CsvFile *csv, TestSuite suite, const RunOptions *options) {
+    switch (suite) {
+        case TEST_SUITE_PARALLELEPIPED:
+            return run_volume_tests(csv, volumeParallelepiped, "Parallelepiped Volume", 1.0, options);
+        case TEST_SUITE_PYRAMID:
+            return run_volume_tests(csv, volumeParallelepiped, "Pyramid Volume", 6.0, options);
+        case TEST_SUITE_CROSS_PRODUCT:
+            return run_cross_product_tests(csv, crossProduct, options);
+        case TEST_SUITE_SCALAR_PRODUCT:
+            return run_scalar_product_tests(csv, scalaricProduct, options);
+    }
+    return false;
+}
+
+// --- Binary Results ---
+
+// Stores one row in every column; test is NULL for a row that did not parse.
+// Without V3 the volume and the dot products with V3 are NaN.
+// Returns the volume pass flag.
+static bool compute_result_row(const TestCase *test, double k_value, bool has_v3, bool has_expected,
+                               double *columns[], size_t row) {
+    if (test == NULL) {
+        for (int c = 0; c < RESULT_COLUMN_COUNT; c++) columns[c][row] = NAN;
+        columns[RESULT_PASSED][row] = columns[RESULT_PERPENDICULAR][row] = columns[RESULT_PARSED][row] = 0.0;
+        return false;
+    }
+
+    // Same kernels and tolerances as the printing runners
+    double volume;
+    if (!has_v3) {
+        volume = NAN;
+    } else if (test->integer_coordinates) {
+        volume = volumeParallelepipedExact(test->int_coordinates, k_value);
+    } else {
+        vector vectors[3] = {test->v1, test->v2, test->v3};
+        volume = volumeParallelepiped(vectors, k_value);
+    }
+    double expected = has_expected ? test->expected_volume / k_value : NAN;
+    bool passed = fabs(volume - expected) < 0.001;
+    vector cross = crossProduct(test->v1, test->v2);
+    bool perpendicular = fabs(scalaricProduct(cross, test->v1)) <= 0.001 &&
+                         fabs(scalaricProduct(cross, test->v2)) <= 0.001;
+
+    columns[RESULT_VOLUME][row] = volume;
+    columns[RESULT_EXPECTED][row] = expected;
+    columns[RESULT_PASSED][row] = passed ? 1.0 : 0.0;
+    columns[RESULT_CROSS_X][row] = cross.direction[0];
+    columns[RESULT_CROSS_Y][row] = cross.direction[1];
+    columns[RESULT_CROSS_Z][row] = cross.direction[2];
+    columns[RESULT_CROSS_MAG][row] = cross.magnitude;
+    columns[RESULT_PERPENDICULAR][row] = perpendicular ? 1.0 : 0.0;
+    columns[RESULT_DOT12][row] = scalaricProduct(test->v1, test->v2);
+    columns[RESULT_DOT13][row] = has_v3 ? scalaricProduct(test->v1, test->v3) : NAN;
+    columns[RESULT_DOT23][row] = has_v3 ? scalaricProduct(test->v2, test->v3) : NAN;
+    columns[RESULT_PARSED][row] = 1.0;
+    return passed;
+}
+
+bool write_test_results(CsvFile *csv, TestSuite suite, const char *path) {
+    static const char *const names[RESULT_COLUMN_COUNT] = {
+        "VOLUME", "EXPECTED_VOLUME", "PASSED",
+        "CROSS_X", "CROSS_Y", "CROSS_Z", "CROSS_MAG", "PERPENDICULAR",
+        "DOT12", "DOT13", "DOT23", "PARSED"
+    };
+    double k_value = suite == TEST_SUITE_PYRAMID ? 6.0 : 1.0;
+    bool volumes = suite == TEST_SUITE_PARALLELEPIPED || suite == TEST_SUITE_PYRAMID;
+    // Same required columns as the suite's printing runner (magnitudes are not stored)
+    unsigned mask = suite == TEST_SUITE_CROSS_PRODUCT ? CSV_MASK_V1 | CSV_MASK_V2 : CSV_MASK_VECTORS;
+    if (volumes) mask |= CSV_MASK_EXPECTED;
+    char header[MAX_LINE_LENGTH];
+    double *columns[RESULT_COLUMN_COUNT];
+    ResultWriter *writer;
+    TestCase *tests;
+    bool *parsed;
+    size_t row_count = 0, row = 0;
+    size_t passed_count = 0, error_count = 0;
+    bool written;
+
+    // First pass: the row count sizes the file
+    if (!prepare_test_file(csv, mask, header)) return false;
+    while (csv_read_line(csv)) row_count++;
+    if (csv_error(csv) != NULL) {
+        printf("ERROR: %s\n", csv_error(csv));
+        return false;
+    }
+    if (!prepare_test_file(csv, mask, header)) return false;
+
+    // The product suites do not need V3 or an expected volume, but keep them when present
+    bool has_v3 = csv_has_columns(csv, CSV_MASK_V3);
+    bool has_expected = csv_has_columns(csv, CSV_MASK_EXPECTED);
+    if (has_v3) mask |= CSV_MASK_V3;
+    if (has_expected) mask |= CSV_MASK_EXPECTED;
+
+    writer = result_writer_create(path, names, RESULT_COLUMN_COUNT, (uint64_t)row_count);
+    if (writer == NULL) return false;
+    tests = (TestCase*)malloc(RESULT_BLOCK_ROWS * sizeof(TestCase));
+    parsed = (bool*)malloc(RESULT_BLOCK_ROWS * sizeof(bool));
+    if (tests == NULL || parsed == NULL) {
+        printf("ERROR: Memory allocation failed\n");
+        free(tests);
+        free(parsed);
+        result_writer_close(writer);
+        return false;
+    }
+    for (int c = 0; c < RESULT_COLUMN_COUNT; c++) columns[c] = result_writer_column(writer, c);
+
+    // Second pass: rows are parsed in order, then each block is computed in
+    // parallel straight into the mapped columns at the rows' offsets
+    while (row < row_count) {
+        size_t block_rows = 0;
+        while (block_rows < RESULT_BLOCK_ROWS && row + block_rows < row_count && csv_read_line(csv)) {
+            parsed[block_rows] = csv_read_test_case_columns(csv, &tests[block_rows], mask);
+            if (!parsed[block_rows]) error_count++;
+            block_rows++;
+        }
+        if (block_rows == 0) break;
+
+        #pragma omp parallel for schedule(static) reduction(+:passed_count)
+        for (long long i = 0; i < (long long)block_rows; i++) {
+            if (compute_result_row(parsed[i] ? &tests[i] : NULL, k_value, has_v3, has_expected, columns,
+                                   row + (size_t)i)) {
+                passed_count++;
+            }
+        }
+        row += block_rows;
+    }
+
+    free(tests);
+    free(parsed);
+    written = result_writer_close(writer);
+    if (row < row_count) {
+        printf("ERROR: The file ended after %zu of %zu rows\n", row, row_count);
+        if (csv_error(csv) != NULL) printf("ERROR: %s\n", csv_error(csv));
+        return false;
+    }
+    if (!written) return false;
+
+    printf("Wrote %zu rows x %d columns to %s\n", row_count, RESULT_COLUMN_COUNT, path);
+    if (has_v3 && has_expected) {
+        printf("Passed: %zu | Failed: %zu | Errors: %zu (k=%.1f)\n", passed_count,
+               row_count - passed_count - error_count, error_count, k_value);
+    } else {
+        printf("Errors: %zu\n", error_count);
+    }
+    return true;
 }
\ No newline at end of file
@@ -1,14 +1,59 @@
 #ifndef TESTER_FILE_H
 #define TESTER_FILE_H
 
+#include <stdint.h>
 #include "mathUtil.h"
 #include "csvHandler.h"
+#include "streamStats.h"
+#include "vectorExpr.h"
 
 // --- Function Pointer Types ---
 typedef double (*VolumeOperation)(vector vectors[], double k);
 typedef double (*BinaryVectorOperation)(vector v1, vector v2);
 typedef vector (*CrossOperation)(vector v1, vector v2);
 
+// --- Test Suites (as selected by name on the command line) ---
+typedef enum {
+    TEST_SUITE_PARALLELEPIPED,
+    TEST_SUITE_PYRAMID,
+    TEST_SUITE_CROSS_PRODUCT,
+    TEST_SUITE_SCALAR_PRODUCT
+} TestSuite;
+
+// --- Run Counters (scalar and cross product runs only count tests and errors) ---
+// 64-bit so runs over more than 2^31 rows keep counting (and checkpointing) correctly
+typedef struct {
+    uint64_t test_count;
+    uint64_t passed_count;
+    uint64_t failed_count;
+    uint64_t error_count;
+    uint64_t exact_count;
+    uint64_t float_count;
+} RunCounters;
+
+// Parts of the report a runner can leave out (RunOptions.quiet)
+#define RUN_QUIET_BANNER  0x1u // "=== Testing ... ===" and notes
+#define RUN_QUIET_SUMMARY 0x2u // Summary after the rows
+
+// --- Run Options ---
+// Optional settings for a runner; pass NULL (or all zero) for a plain run
+typedef struct {
+    const char *checkpoint_path; // State file for checkpoints (NULL = none)
+    int checkpoint_interval;     // Rows between checkpoints (<= 0 = default)
+    bool resume;                 // Continue from checkpoint_path when it matches this run
+
+    // Partial runs over a byte range of a plain file (see shardRunner.h)
+    long long range_start;       // Byte offset of the first row (0 = the row after the header)
+    long long range_end;         // Byte offset where the rows stop (0 = end of file)
+    const RunCounters *start;    // Counts before range_start: numbering and totals continue from here
+    RunCounters *counters;       // Receives the final counts (untouched if the file cannot be run)
+    unsigned quiet;              // RUN_QUIET_* parts of the report not to print
+
+    // Distribution of the computed values (volumes, cross product magnitudes or
+    // dot products), printed after the summary; NULL = not collected
+    ValueStats *stats;           // stats_init'ed by the caller; values are added to it
+} RunOptions;
+
 // --- Test Runner Function Prototypes ---
 
 /**
@@ -17,21 +62,73 @@ typedef vector (*CrossOperation)(vector v1, vector v2);
  * @param operation Function pointer to volume calculation function
  * @param test_name Name of the test for display
  * @param k_value The k constant for volume calculation (1.0 for parallelepiped, 6.0 for pyramid)
+ * @param options Run options, or NULL
+ * @return false if the file could not be run or reading it stopped at an error
  */
-void run_volume_tests(CsvFile *csv, VolumeOperation operation, const char *test_name, double k_value);
+bool run_volume_tests(CsvFile *csv, VolumeOperation operation, const char *test_name, double k_value,
+                      const RunOptions *options);
 
 /**
  * @brief Runs scalar product tests on CSV data
  * @param csv Opened CSV file pointer
  * @param operation Function pointer to scalar product function
+ * @param options Run options, or NULL
+ * @return false if the file could not be run or reading it stopped at an error
  */
-void run_scalar_product_tests(CsvFile *csv, BinaryVectorOperation operation);
+bool run_scalar_product_tests(CsvFile *csv, BinaryVectorOperation operation, const RunOptions *options);
 
 /**
  * @brief Runs cross product tests on CSV data
  * @param csv Opened CSV file pointer
  * @param operation Function pointer to cross product function
+ * @param options Run options, or NULL
+ * @return false if the file could not be run or reading it stopped at an error
+ */
+bool run_cross_product_tests(CsvFile *csv, CrossOperation operation, const RunOptions *options);
+
+/**
+ * @brief Evaluates a compiled expression (see vectorExpr.h) on every row and
+ * prints the results like the other runners. Rows are parsed in blocks and
+ * each block is evaluated in one batch; only the vectors the expression uses
+ * are decoded.
+ * @param csv Opened CSV file pointer
+ * @param expr Compiled expression
+ * @param options Run options, or NULL
+ * @return false if the file could not be run or reading it stopped at an error
+ */
+bool run_expression_tests(CsvFile *csv, const VectorExpr *expr, const RunOptions *options);
+
+/**
+ * @brief Looks up a test suite by its command line name
+ * @param name parallelepiped, pyramid, cross or scalar
+ * @param suite Receives the suite
+ * @return true if the name is known
+ */
+bool test_suite_from_name(const char *name, TestSuite *suite);
+
+/**
+ * @brief Computes the results of a test file into a binary result file (see
+ * resultFile.h) instead of printing them: volume, expected volume and pass flag,
+ * cross product and magnitude with the perpendicularity flag, the three dot
+ * products, and whether the row parsed. The columns needed are those of the
+ * suite's runner (V1 and V2 for cross); without V3 the volume, DOT13 and DOT23
+ * are NaN. Rows keep their file order. The file is
+ * sized from a first pass that counts the rows, then mapped; blocks of parsed
+ * rows are computed in parallel, each thread storing its rows in place.
+ * @param csv Opened CSV file pointer
+ * @param suite Suite whose volume divisor is used (6 for pyramid, else 1)
+ * @param path Binary result file to create
+ * @return true on success
+ */
+bool write_test_results(CsvFile *csv, TestSuite suite, const char *path);
+
+/**
+ * @brief Runs one test suite with the stock kernels
+ * @param csv Opened CSV file pointer
+ * @param suite Suite to run
+ * @param options Run options, or NULL
+ * @return false if the file could not be run or reading it stopped at an error
  */
-void run_cross_product_tests(CsvFile *csv, CrossOperation operation);
+bool run_test_suite(CsvFile *csv, TestSuite suite, const RunOptions *options);
 
 #endif // TESTER_FILE_H
\ No newline at end of file
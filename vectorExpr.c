@@ -0,0 +1,644 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "vectorExpr.h"
+
+// Each operation rounds on its own, like the scalar code it replaces: the
+// merged a + b * c must not become a fused multiply-add
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#define EXPR_LANES 256 // Rows per instruction pass; slot_count lanes stay in L1/L2
+
+// --- Data Structures ---
+
+// Value being compiled: instruction of each component
+typedef struct {
+    int dimension; // 1 or 3
+    int reg[3];
+} ExprValue;
+
+typedef struct {
+    const char *text;
+    const char *cursor;
+    VectorExpr *expr;
+    char *error;
+    size_t error_size;
+    bool failed;
+} ExprParser;
+
+// --- Helper Prototypes ---
+static void fail(ExprParser *parser, const char *message);
+static int emit(ExprParser *parser, ExprOpcode op, int a, int b);
+static int emit_load(ExprParser *parser, int input, int component);
+static int emit_const(ExprParser *parser, double constant);
+static bool accept(ExprParser *parser, const char *token);
+static bool accept_word(ExprParser *parser, const char *word);
+static bool read_identifier(ExprParser *parser, char *name, size_t size);
+static ExprValue scalar(int reg);
+static ExprValue combine(ExprParser *parser, ExprOpcode op, ExprValue lhs, ExprValue rhs);
+static ExprValue cross(ExprParser *parser, ExprValue lhs, ExprValue rhs);
+static ExprValue dot(ExprParser *parser, ExprValue lhs, ExprValue rhs);
+static ExprValue norm(ExprParser *parser, ExprValue value);
+static ExprValue normalize(ExprParser *parser, ExprValue value);
+static ExprValue parse_sum(ExprParser *parser);
+static ExprValue parse_product(ExprParser *parser);
+static ExprValue parse_unary(ExprParser *parser);
+static ExprValue parse_primary(ExprParser *parser);
+static ExprValue parse_call(ExprParser *parser, const char *name);
+static void remove_dead_code(VectorExpr *expr);
+static void merge_products(VectorExpr *expr);
+static bool assign_slots(VectorExpr *expr);
+static void load_lanes(const PackedVector *const vectors[3], const int load_slots[3][3], size_t start, size_t rows,
+                       double *scratch);
+static void run_lane(const VectorExpr *expr, const PackedVector *const vectors[3], const int load_slots[3][3],
+                     size_t start, size_t rows, double *scratch, double *out);
+
+// Keeps the first error; later ones follow from it
+static void fail(ExprParser *parser, const char *message) {
+    if (parser->failed) return;
+    parser->failed = true;
+    snprintf(parser->error, parser->error_size, "%s at column %d", message, (int)(parser->cursor - parser->text) + 1);
+}
+
+// --- Code Generation ---
+
+// Appends an arithmetic instruction: constant operands are folded, x * 1 is x,
+// and an instruction already in the program is reused
+static int emit(ExprParser *parser, ExprOpcode op, int a, int b) {
+    VectorExpr *expr = parser->expr;
+    ExprInstruction *code = expr->code;
+
+    if (parser->failed) return 0;
+    if (code[a].op == EXPR_CONST && (b < 0 || code[b].op == EXPR_CONST)) {
+        double x = code[a].constant, y = b >= 0 ? code[b].constant : 0.0;
+        switch (op) {
+            case EXPR_ADD:  return emit_const(parser, x + y);
+            case EXPR_SUB:  return emit_const(parser, x - y);
+            case EXPR_MUL:  return emit_const(parser, x * y);
+            case EXPR_DIV:  return emit_const(parser, x / y);
+            case EXPR_NEG:  return emit_const(parser, -x);
+            case EXPR_SQRT: return emit_const(parser, sqrt(x));
+            case EXPR_ABS:  return emit_const(parser, fabs(x));
+            default:        break;
+        }
+    }
+    if (op == EXPR_ADD || op == EXPR_MUL) {
+        if (b < a) {
+            int swap = a;
+            a = b;
+            b = swap;
+        }
+        if (op == EXPR_MUL && code[a].op == EXPR_CONST && code[a].constant == 1.0) return b;
+        if (op == EXPR_MUL && code[b].op == EXPR_CONST && code[b].constant == 1.0) return a;
+    }
+
+    for (int i = 0; i < expr->count; i++) {
+        if (code[i].op == op && code[i].a == a && code[i].b == b) return i;
+    }
+    if (expr->count == EXPR_MAX_INSTRUCTIONS) {
+        fail(parser, "Expression too long");
+        return 0;
+    }
+    code[expr->count] = (ExprInstruction){ op, a, b, -1, -1, -1, -1, 0.0, -1 };
+    return expr->count++;
+}
+
+static int emit_load(ExprParser *parser, int input, int component) {
+    VectorExpr *expr = parser->expr;
+
+    if (parser->failed) return 0;
+    for (int i = 0; i < expr->count; i++) {
+        if (expr->code[i].op == EXPR_LOAD && expr->code[i].input == input && expr->code[i].component == component) return i;
+    }
+    if (expr->count == EXPR_MAX_INSTRUCTIONS) {
+        fail(parser, "Expression too long");
+        return 0;
+    }
+    expr->code[expr->count] = (ExprInstruction){ EXPR_LOAD, -1, -1, -1, -1, input, component, 0.0, -1 };
+    return expr->count++;
+}
+
+static int emit_const(ExprParser *parser, double constant) {
+    VectorExpr *expr = parser->expr;
+
+    if (parser->failed) return 0;
+    for (int i = 0; i < expr->count; i++) {
+        if (expr->code[i].op == EXPR_CONST && memcmp(&expr->code[i].constant, &constant, sizeof(double)) == 0) return i;
+    }
+    if (expr->count == EXPR_MAX_INSTRUCTIONS) {
+        fail(parser, "Expression too long");
+        return 0;
+    }
+    expr->code[expr->count] = (ExprInstruction){ EXPR_CONST, -1, -1, -1, -1, -1, -1, constant, -1 };
+    return expr->count++;
+}
+
+// --- Vector Operations (expanded to components) ---
+
+static ExprValue scalar(int reg) {
+    ExprValue value = { 1, { reg, reg, reg } };
+    return value;
+}
+
+// Component-wise + - * /; a scalar operand of * and / scales a vector
+static ExprValue combine(ExprParser *parser, ExprOpcode op, ExprValue lhs, ExprValue rhs) {
+    ExprValue result = lhs.dimension >= rhs.dimension ? lhs : rhs;
+
+    if ((op == EXPR_ADD || op == EXPR_SUB) && lhs.dimension != rhs.dimension) {
+        fail(parser, "Cannot add or subtract a scalar and a vector");
+    } else if (op == EXPR_MUL && lhs.dimension == 3 && rhs.dimension == 3) {
+        fail(parser, "Use x (cross) or . (dot) between two vectors");
+    } else if (op == EXPR_DIV && rhs.dimension == 3) {
+        fail(parser, "Cannot divide by a vector");
+    }
+    for (int c = 0; c < result.dimension; c++) {
+        result.reg[c] = emit(parser, op, lhs.reg[lhs.dimension == 3 ? c : 0], rhs.reg[rhs.dimension == 3 ? c : 0]);
+    }
+    return result;
+}
+
+// Same expansion and order as crossProduct
+static ExprValue cross(ExprParser *parser, ExprValue lhs, ExprValue rhs) {
+    const int *a = lhs.reg, *b = rhs.reg;
+    ExprValue result = { 3, { 0, 0, 0 } };
+
+    if (lhs.dimension != 3 || rhs.dimension != 3) {
+        fail(parser, "The cross product needs two vectors");
+        return result;
+    }
+    result.reg[0] = emit(parser, EXPR_SUB, emit(parser, EXPR_MUL, a[1], b[2]), emit(parser, EXPR_MUL, b[1], a[2]));
+    result.reg[1] = emit(parser, EXPR_SUB, emit(parser, EXPR_MUL, a[2], b[0]), emit(parser, EXPR_MUL, a[0], b[2]));
+    result.reg[2] = emit(parser, EXPR_SUB, emit(parser, EXPR_MUL, a[0], b[1]), emit(parser, EXPR_MUL, b[0], a[1]));
+    return result;
+}
+
+// Same summation order as scalaricProduct
+static ExprValue dot(ExprParser *parser, ExprValue lhs, ExprValue rhs) {
+    int sum;
+
+    if (lhs.dimension != 3 || rhs.dimension != 3) {
+        fail(parser, "The dot product needs two vectors");
+        return scalar(0);
+    }
+    // Starting from +0 like the loop, so an all -0 sum is +0 there too
+    sum = emit(parser, EXPR_ADD, emit_const(parser, 0.0), emit(parser, EXPR_MUL, lhs.reg[0], rhs.reg[0]));
+    sum = emit(parser, EXPR_ADD, sum, emit(parser, EXPR_MUL, lhs.reg[1], rhs.reg[1]));
+    sum = emit(parser, EXPR_ADD, sum, emit(parser, EXPR_MUL, lhs.reg[2], rhs.reg[2]));
+    return scalar(sum);
+}
+
+// Magnitude of a vector, absolute value of a scalar
+static ExprValue norm(ExprParser *parser, ExprValue value) {
+    if (value.dimension == 1) return scalar(emit(parser, EXPR_ABS, value.reg[0], -1));
+    return scalar(emit(parser, EXPR_SQRT, dot(parser, value, value).reg[0], -1));
+}
+
+// One sqrt and one division, then three multiplications (a zero vector gives NaN)
+static ExprValue normalize(ExprParser *parser, ExprValue value) {
+    if (value.dimension != 3) {
+        fail(parser, "normalize() needs a vector");
+        return value;
+    }
+    int inverse = emit(parser, EXPR_DIV, emit_const(parser, 1.0), norm(parser, value).reg[0]);
+    return combine(parser, EXPR_MUL, value, scalar(inverse));
+}
+
+// --- Parsing ---
+
+static bool accept(ExprParser *parser, const char *token) {
+    size_t length = strlen(token);
+
+    while (isspace((unsigned char)*parser->cursor)) parser->cursor++;
+    if (strncmp(parser->cursor, token, length) != 0) return false;
+    parser->cursor += length;
+    return true;
+}
+
+// A whole word (the cross operator x must not start an identifier)
+static bool accept_word(ExprParser *parser, const char *word) {
+    const char *start = parser->cursor;
+    char name[16];
+
+    if (read_identifier(parser, name, sizeof(name)) && strcmp(name, word) == 0) return true;
+    parser->cursor = start;
+    return false;
+}
+
+static bool read_identifier(ExprParser *parser, char *name, size_t size) {
+    size_t length = 0;
+
+    while (isspace((unsigned char)*parser->cursor)) parser->cursor++;
+    if (!isalpha((unsigned char)*parser->cursor)) return false;
+    while (isalnum((unsigned char)*parser->cursor) || *parser->cursor == '_') {
+        if (length + 1 < size) name[length++] = (char)tolower((unsigned char)*parser->cursor);
+        parser->cursor++;
+    }
+    name[length] = '\0';
+    return true;
+}
+
+// sum := product (('+' | '-') product)*
+static ExprValue parse_sum(ExprParser *parser) {
+    ExprValue value = parse_product(parser);
+
+    for (;;) {
+        if (accept(parser, "+")) {
+            value = combine(parser, EXPR_ADD, value, parse_product(parser));
+        } else if (accept(parser, "-")) {
+            value = combine(parser, EXPR_SUB, value, parse_product(parser));
+        } else {
+            return value;
+        }
+    }
+}
+
+// product := unary (('*' | '/' | 'x' | '×' | '.' | '·') unary)*, left to right
+static ExprValue parse_product(ExprParser *parser) {
+    ExprValue value = parse_unary(parser);
+
+    while (!parser->failed) {
+        if (accept(parser, "*")) {
+            value = combine(parser, EXPR_MUL, value, parse_unary(parser));
+        } else if (accept(parser, "/")) {
+            value = combine(parser, EXPR_DIV, value, parse_unary(parser));
+        } else if (accept_word(parser, "x") || accept(parser, "\xc3\x97")) {
+            value = cross(parser, value, parse_unary(parser));
+        } else if (accept(parser, ".") || accept(parser, "\xc2\xb7")) {
+            value = dot(parser, value, parse_unary(parser));
+        } else {
+            break;
+        }
+    }
+    return value;
+}
+
+static ExprValue parse_unary(ExprParser *parser) {
+    if (accept(parser, "-")) {
+        ExprValue value = parse_unary(parser);
+        for (int c = 0; c < value.dimension; c++) value.reg[c] = emit(parser, EXPR_NEG, value.reg[c], -1);
+        return value;
+    }
+    if (accept(parser, "+")) return parse_unary(parser);
+    return parse_primary(parser);
+}
+
+// primary := number | V1 | V2 | V3 | function '(' ... ')' | '(' sum ')' | '|' sum '|'
+static ExprValue parse_primary(ExprParser *parser) {
+    char name[16];
+    const char *start;
+    char *end;
+    double number;
+
+    if (parser->failed) return scalar(0);
+    if (accept(parser, "(")) {
+        ExprValue value = parse_sum(parser);
+        if (!accept(parser, ")")) fail(parser, "Expected ')'");
+        return value;
+    }
+    if (accept(parser, "|")) {
+        ExprValue value = norm(parser, parse_sum(parser));
+        if (!accept(parser, "|")) fail(parser, "Expected '|'");
+        return value;
+    }
+
+    start = parser->cursor;
+    if (read_identifier(parser, name, sizeof(name))) {
+        if (name[0] == 'v' && name[1] >= '1' && name[1] <= '3' && name[2] == '\0') {
+            int input = name[1] - '1';
+            ExprValue value = { 3, { 0, 0, 0 } };
+            for (int c = 0; c < 3; c++) value.reg[c] = emit_load(parser, input, c);
+            return value;
+        }
+        if (accept(parser, "(")) return parse_call(parser, name);
+        parser->cursor = start;
+        fail(parser, "Unknown name (expected V1, V2, V3 or a function)");
+        return scalar(0);
+    }
+
+    number = strtod(parser->cursor, &end);
+    if (end == parser->cursor) {
+        fail(parser, *parser->cursor == '\0' ? "Unexpected end of expression" : "Expected a value");
+        return scalar(0);
+    }
+    parser->cursor = end;
+    return scalar(emit_const(parser, number));
+}
+
+// After "name(": one or two arguments and the closing parenthesis
+static ExprValue parse_call(ExprParser *parser, const char *name) {
+    bool binary = strcmp(name, "dot") == 0 || strcmp(name, "cross") == 0;
+    ExprValue first = parse_sum(parser), second = first, result = first;
+
+    if (binary) {
+        if (!accept(parser, ",")) fail(parser, "Expected ','");
+        second = parse_sum(parser);
+    }
+    if (!accept(parser, ")")) fail(parser, "Expected ')'");
+
+    if (strcmp(name, "dot") == 0) {
+        result = dot(parser, first, second);
+    } else if (strcmp(name, "cross") == 0) {
+        result = cross(parser, first, second);
+    } else if (strcmp(name, "norm") == 0 || strcmp(name, "mag") == 0) {
+        result = norm(parser, first);
+    } else if (strcmp(name, "normalize") == 0) {
+        result = normalize(parser, first);
+    } else if (strcmp(name, "sqrt") == 0 || strcmp(name, "abs") == 0) {
+        if (first.dimension != 1) fail(parser, "sqrt() and abs() need a scalar");
+        result = scalar(emit(parser, name[0] == 's' ? EXPR_SQRT : EXPR_ABS, first.reg[0], -1));
+    } else {
+        fail(parser, "Unknown function");
+    }
+    return result;
+}
+
+// Drops instructions the result does not depend on (folded constants, mostly)
+static void remove_dead_code(VectorExpr *expr) {
+    bool live[EXPR_MAX_INSTRUCTIONS] = { false };
+    int renumbered[EXPR_MAX_INSTRUCTIONS];
+    int count = 0;
+
+    for (int c = 0; c < expr->dimension; c++) live[expr->result[c]] = true;
+    for (int i = expr->count - 1; i >= 0; i--) {
+        if (!live[i]) continue;
+        if (expr->code[i].a >= 0) live[expr->code[i].a] = true;
+        if (expr->code[i].b >= 0) live[expr->code[i].b] = true;
+        if (expr->code[i].c >= 0) live[expr->code[i].c] = true;
+        if (expr->code[i].d >= 0) live[expr->code[i].d] = true;
+    }
+
+    expr->mask = 0;
+    for (int i = 0; i < expr->count; i++) {
+        ExprInstruction in = expr->code[i];
+        if (!live[i]) continue;
+        if (in.a >= 0) in.a = renumbered[in.a];
+        if (in.b >= 0) in.b = renumbered[in.b];
+        if (in.c >= 0) in.c = renumbered[in.c];
+        if (in.d >= 0) in.d = renumbered[in.d];
+        if (in.op == EXPR_LOAD) expr->mask |= CSV_MASK((CsvColumn)(CSV_COL_V1_X + 4 * in.input + in.component));
+        renumbered[i] = count;
+        expr->code[count++] = in;
+    }
+    for (int c = 0; c < 3; c++) expr->result[c] = renumbered[expr->result[c]];
+    expr->count = count;
+}
+
+// Folds a product used only by one sum or difference into it, so the cross
+// product component a1 * b2 - b1 * a2 is one pass over the lane instead of
+// three. Sums are commutative in IEEE arithmetic, so a product on either side
+// of + can be merged; for - only the subtracted product or both.
+static void merge_products(VectorExpr *expr) {
+    int uses[EXPR_MAX_INSTRUCTIONS] = { 0 };
+    ExprInstruction *code = expr->code;
+
+    for (int i = 0; i < expr->count; i++) {
+        if (code[i].a >= 0) uses[code[i].a]++;
+        if (code[i].b >= 0) uses[code[i].b]++;
+    }
+    for (int c = 0; c < expr->dimension; c++) uses[expr->result[c]]++;
+
+    for (int i = 0; i < expr->count; i++) {
+        ExprInstruction *in = &code[i];
+        if (in->op != EXPR_ADD && in->op != EXPR_SUB) continue;
+
+        bool left = code[in->a].op == EXPR_MUL && uses[in->a] == 1;
+        bool right = code[in->b].op == EXPR_MUL && uses[in->b] == 1;
+        int lhs = in->a, rhs = in->b;
+
+        if (left && right) {
+            in->op = in->op == EXPR_ADD ? EXPR_MUL_MUL_ADD : EXPR_MUL_MUL_SUB;
+            in->a = code[lhs].a;
+            in->b = code[lhs].b;
+            in->c = code[rhs].a;
+            in->d = code[rhs].b;
+        } else if (right || (left && in->op == EXPR_ADD)) {
+            int product = right ? rhs : lhs;
+            in->op = in->op == EXPR_ADD ? EXPR_MUL_ADD : EXPR_MUL_SUB;
+            in->a = right ? lhs : rhs;
+            in->b = code[product].a;
+            in->c = code[product].b;
+        }
+    }
+    remove_dead_code(expr); // The merged products are no longer referenced
+}
+
+// Gives every instruction a scratch lane. Constants and input coordinates keep
+// their own lanes, filled before the program runs; other lanes are reused after
+// their last use (an operand's lane can take the result: evaluation is
+// element-wise).
+static bool assign_slots(VectorExpr *expr) {
+    int last_use[EXPR_MAX_INSTRUCTIONS];
+    int free_slots[EXPR_MAX_SLOTS];
+    int free_count = 0;
+
+    for (int i = 0; i < expr->count; i++) last_use[i] = i;
+    for (int i = 0; i < expr->count; i++) {
+        const ExprInstruction *in = &expr->code[i];
+        int operands[4] = { in->a, in->b, in->c, in->d };
+        for (int o = 0; o < 4; o++) {
+            if (operands[o] >= 0) last_use[operands[o]] = i;
+        }
+    }
+    for (int c = 0; c < expr->dimension; c++) last_use[expr->result[c]] = expr->count;
+
+    expr->slot_count = 0;
+    for (int i = 0; i < expr->count; i++) {
+        if (expr->code[i].op != EXPR_CONST && expr->code[i].op != EXPR_LOAD) continue;
+        if (expr->slot_count == EXPR_MAX_SLOTS) return false;
+        expr->code[i].slot = expr->slot_count++;
+    }
+
+    for (int i = 0; i < expr->count; i++) {
+        ExprInstruction *in = &expr->code[i];
+        int operands[4] = { in->a, in->b, in->c, in->d };
+
+        if (in->op == EXPR_CONST || in->op == EXPR_LOAD) continue;
+        for (int o = 0; o < 4; o++) {
+            bool repeated = false;
+            for (int earlier = 0; earlier < o; earlier++) repeated = repeated || operands[earlier] == operands[o];
+            if (operands[o] < 0 || repeated || last_use[operands[o]] != i ||
+                expr->code[operands[o]].op == EXPR_CONST || expr->code[operands[o]].op == EXPR_LOAD) continue;
+            free_slots[free_count++] = expr->code[operands[o]].slot;
+        }
+        if (free_count > 0) {
+            in->slot = free_slots[--free_count];
+        } else if (expr->slot_count < EXPR_MAX_SLOTS) {
+            in->slot = expr->slot_count++;
+        } else {
+            return false;
+        }
+        if (last_use[i] == i) free_slots[free_count++] = in->slot; // Unused result
+    }
+    return true;
+}
+
+bool expr_compile(const char *text, VectorExpr *expr, char *error, size_t error_size) {
+    ExprParser parser = { text, text, expr, error, error_size, false };
+    ExprValue value;
+
+    memset(expr, 0, sizeof(*expr));
+    snprintf(expr->text, sizeof(expr->text), "%s", text);
+
+    value = parse_sum(&parser);
+    while (isspace((unsigned char)*parser.cursor)) parser.cursor++;
+    if (!parser.failed && *parser.cursor != '\0') fail(&parser, "Unexpected text");
+    if (parser.failed) return false;
+
+    expr->dimension = value.dimension;
+    for (int c = 0; c < 3; c++) expr->result[c] = value.reg[c];
+    remove_dead_code(expr);
+    merge_products(expr);
+    if (!assign_slots(expr)) {
+        snprintf(error, error_size, "Expression needs more than %d intermediate values", EXPR_MAX_SLOTS);
+        return false;
+    }
+    return true;
+}
+
+// --- Evaluation ---
+
+// Copies the coordinates the program reads into their lanes. A vector whose
+// three coordinates are all read is split in a single pass over its rows.
+static void load_lanes(const PackedVector *const vectors[3], const int load_slots[3][3], size_t start, size_t rows,
+                       double *scratch) {
+    for (int input = 0; input < 3; input++) {
+        const int *slots = load_slots[input];
+        if (slots[0] < 0 && slots[1] < 0 && slots[2] < 0) continue;
+
+        const PackedVector *source = vectors[input] + start;
+        if (slots[0] >= 0 && slots[1] >= 0 && slots[2] >= 0) {
+            double *x = scratch + (size_t)slots[0] * EXPR_LANES;
+            double *y = scratch + (size_t)slots[1] * EXPR_LANES;
+            double *z = scratch + (size_t)slots[2] * EXPR_LANES;
+            #pragma omp simd
+            for (size_t r = 0; r < rows; r++) {
+                x[r] = source[r].direction[0];
+                y[r] = source[r].direction[1];
+                z[r] = source[r].direction[2];
+            }
+            continue;
+        }
+        for (int component = 0; component < 3; component++) {
+            if (slots[component] < 0) continue;
+            double *lane = scratch + (size_t)slots[component] * EXPR_LANES;
+            for (size_t r = 0; r < rows; r++) lane[r] = source[r].direction[component];
+        }
+    }
+}
+
+// Runs every instruction over rows [start, start + rows), rows <= EXPR_LANES
+static void run_lane(const VectorExpr *expr, const PackedVector *const vectors[3], const int load_slots[3][3],
+                     size_t start, size_t rows, double *scratch, double *out) {
+    // A computed scalar result goes straight to out instead of through its lane
+    ExprOpcode result_op = expr->code[expr->result[0]].op;
+    int direct = expr->dimension == 1 && result_op != EXPR_LOAD && result_op != EXPR_CONST ? expr->result[0] : -1;
+
+    load_lanes(vectors, load_slots, start, rows, scratch);
+
+    for (int i = 0; i < expr->count; i++) {
+        const ExprInstruction *in = &expr->code[i];
+        double *d = i == direct ? out + start : scratch + (size_t)in->slot * EXPR_LANES;
+        const double *x = in->a >= 0 ? scratch + (size_t)expr->code[in->a].slot * EXPR_LANES : NULL;
+        const double *y = in->b >= 0 ? scratch + (size_t)expr->code[in->b].slot * EXPR_LANES : NULL;
+        const double *z = in->c >= 0 ? scratch + (size_t)expr->code[in->c].slot * EXPR_LANES : NULL;
+        const double *w = in->d >= 0 ? scratch + (size_t)expr->code[in->d].slot * EXPR_LANES : NULL;
+
+        switch (in->op) {
+            case EXPR_LOAD:  // Filled by load_lanes
+            case EXPR_CONST: // Filled by expr_evaluate
+                break;
+            case EXPR_ADD:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = x[r] + y[r];
+                break;
+            case EXPR_SUB:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = x[r] - y[r];
+                break;
+            case EXPR_MUL:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = x[r] * y[r];
+                break;
+            case EXPR_DIV:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = x[r] / y[r];
+                break;
+            case EXPR_NEG:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = -x[r];
+                break;
+            case EXPR_SQRT:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = sqrt(x[r]);
+                break;
+            case EXPR_ABS:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = fabs(x[r]);
+                break;
+            case EXPR_MUL_ADD:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = x[r] + y[r] * z[r];
+                break;
+            case EXPR_MUL_SUB:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = x[r] - y[r] * z[r];
+                break;
+            case EXPR_MUL_MUL_ADD:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = x[r] * y[r] + z[r] * w[r];
+                break;
+            case EXPR_MUL_MUL_SUB:
+                #pragma omp simd
+                for (size_t r = 0; r < rows; r++) d[r] = x[r] * y[r] - z[r] * w[r];
+                break;
+        }
+    }
+
+    for (int c = 0; c < expr->dimension && direct < 0; c++) {
+        const double *result = scratch + (size_t)expr->code[expr->result[c]].slot * EXPR_LANES;
+        double *target = out + start * (size_t)expr->dimension + (size_t)c;
+        for (size_t r = 0; r < rows; r++) target[r * (size_t)expr->dimension] = result[r];
+    }
+}
+
+bool expr_evaluate(const VectorExpr *expr, const PackedVector *const vectors[3], size_t count, double *out) {
+    long long lanes = (long long)((count + EXPR_LANES - 1) / EXPR_LANES);
+    int load_slots[3][3] = { { -1, -1, -1 }, { -1, -1, -1 }, { -1, -1, -1 } };
+    bool failed = false;
+
+    for (int i = 0; i < expr->count; i++) {
+        if (expr->code[i].op == EXPR_LOAD) load_slots[expr->code[i].input][expr->code[i].component] = expr->code[i].slot;
+    }
+
+    // One lane per thread is not worth waking the team for
+    #pragma omp parallel if (lanes > 1)
+    {
+        double *scratch = (double*)malloc((size_t)(expr->slot_count > 0 ? expr->slot_count : 1) * EXPR_LANES *
+                                          sizeof(double));
+        if (scratch == NULL) {
+            #pragma omp atomic write
+            failed = true;
+        } else {
+            for (int i = 0; i < expr->count; i++) {
+                if (expr->code[i].op != EXPR_CONST) continue;
+                double *lane = scratch + (size_t)expr->code[i].slot * EXPR_LANES;
+                for (size_t r = 0; r < EXPR_LANES; r++) lane[r] = expr->code[i].constant;
+            }
+        }
+
+        #pragma omp for schedule(static)
+        for (long long lane = 0; lane < lanes; lane++) {
+            size_t start = (size_t)lane * EXPR_LANES;
+            size_t rows = count - start < EXPR_LANES ? count - start : EXPR_LANES;
+            if (scratch != NULL) run_lane(expr, vectors, load_slots, start, rows, scratch, out);
+        }
+        free(scratch);
+    }
+    return !failed;
+}
@@ -0,0 +1,77 @@
+#ifndef VECTOR_EXPR_H
+#define VECTOR_EXPR_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "csvHandler.h"
+
+#define EXPR_MAX_TEXT 256
+#define EXPR_MAX_INSTRUCTIONS 256
+#define EXPR_MAX_SLOTS 64 // Values live at the same time
+
+// --- Compiled Program ---
+// An expression is flattened into scalar instructions: vectors become three
+// components, common subexpressions are shared (one sqrt for |V1 x V2| and
+// normalize(V1 x V2)), constants are folded and products used once are merged
+// into the sum or difference that consumes them
+
+typedef enum {
+    EXPR_LOAD,  // Coordinate of an input vector
+    EXPR_CONST,
+    EXPR_ADD, EXPR_SUB, EXPR_MUL, EXPR_DIV,
+    EXPR_NEG, EXPR_SQRT, EXPR_ABS,
+    // Merged products; each product and sum is still rounded on its own
+    EXPR_MUL_ADD,     // a + b * c
+    EXPR_MUL_SUB,     // a - b * c
+    EXPR_MUL_MUL_ADD, // a * b + c * d
+    EXPR_MUL_MUL_SUB  // a * b - c * d
+} ExprOpcode;
+
+typedef struct {
+    ExprOpcode op;
+    int a, b, c, d;    // Operand instructions (-1 when unused)
+    int input;         // EXPR_LOAD: 0-2 for V1-V3
+    int component;     // EXPR_LOAD: 0-2 for x, y, z
+    double constant;   // EXPR_CONST
+    int slot;          // Scratch lane of the result during evaluation
+} ExprInstruction;
+
+typedef struct {
+    ExprInstruction code[EXPR_MAX_INSTRUCTIONS];
+    int count;
+    int dimension;               // 1 for a scalar, 3 for a vector
+    int result[3];               // Instructions of the result components
+    int slot_count;
+    unsigned mask;               // CSV columns the expression reads (CSV_MASK_*)
+    char text[EXPR_MAX_TEXT];    // Source text
+} VectorExpr;
+
+// --- Function Prototypes ---
+
+/**
+ * @brief Compiles an expression over V1, V2 and V3, such as "(V1 x V2) . V3",
+ * "V1 + V2 - V3" or "normalize(V1 x V2)".
+ * Operators: + - (same kind), * / (by a scalar), x or × (cross), . or · (dot).
+ * Functions: dot(a, b), cross(a, b), norm(a) (also |a|), normalize(a), sqrt(s), abs(s).
+ * @param text Expression
+ * @param expr Receives the program
+ * @param error Receives a message on failure
+ * @param error_size Size of error
+ * @return true on success
+ */
+bool expr_compile(const char *text, VectorExpr *expr, char *error, size_t error_size);
+
+/**
+ * @brief Evaluates a compiled expression for many rows. Rows are processed in
+ * lanes: the input coordinates are copied into scratch lanes, then every
+ * instruction runs over the lane before the next one, and lanes are split
+ * across threads.
+ * @param expr Compiled expression
+ * @param vectors V1, V2 and V3 arrays (count entries each; unused ones may be NULL)
+ * @param count Number of rows
+ * @param out count * dimension values, row by row
+ * @return false if the scratch memory could not be allocated
+ */
+bool expr_evaluate(const VectorExpr *expr, const PackedVector *const vectors[3], size_t count, double *out);
+
+#endif // VECTOR_EXPR_H
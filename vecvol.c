@@ -0,0 +1,392 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include "vecvol.h"
+#include "mathUtil.h"
+#include "csvHandler.h"
+
+#define VV_ERROR_LENGTH 256
+#define VV_PARALLEL_MIN 65536 // Smaller batches are not worth waking threads for
+
+// --- Context Definition (opaque to callers) ---
+struct VvContext {
+    double tolerance;
+    char last_error[VV_ERROR_LENGTH];
+};
+
+// --- Helper Prototypes ---
+static VvStatus set_error(VvContext *ctx, VvStatus status, const char *message);
+static VvStatus open_test_file(VvContext *ctx, const char *csv_path, unsigned mask, CsvFile **out_csv);
+static VvStatus close_test_file(VvContext *ctx, CsvFile *csv);
+
+// Records a message on the context and passes the status through
+static VvStatus set_error(VvContext *ctx, VvStatus status, const char *message) {
+    if (ctx != NULL) {
+        snprintf(ctx->last_error, sizeof(ctx->last_error), "%s", message);
+    }
+    return status;
+}
+
+// Opens a test CSV, maps its header and checks the runner's columns exist
+static VvStatus open_test_file(VvContext *ctx, const char *csv_path, unsigned mask, CsvFile **out_csv) {
+    CsvFile *csv = csv_open_quiet(csv_path);
+    if (csv == NULL) {
+        char message[VV_ERROR_LENGTH];
+        snprintf(message, sizeof(message), "Cannot open '%s': %s", csv_path, strerror(errno));
+        return set_error(ctx, errno == ENOMEM ? VV_ERR_OUT_OF_MEMORY : VV_ERR_IO, message);
+    }
+
+    if (!csv_read_line(csv)) {
+        if (csv_error(csv) != NULL) return close_test_file(ctx, csv);
+        csv_close(csv);
+        return set_error(ctx, VV_ERR_FORMAT, "CSV file is empty or has no header");
+    }
+
+    csv_map_header(csv);
+    if (!csv_has_columns(csv, mask)) {
+        csv_close(csv);
+        return set_error(ctx, VV_ERR_FORMAT, "CSV header is missing columns required by this runner");
+    }
+
+    *out_csv = csv;
+    return VV_OK;
+}
+
+// Closes a test CSV; reading that stopped at an error (say a truncated .gz)
+// fails the run instead of passing for a short file
+static VvStatus close_test_file(VvContext *ctx, CsvFile *csv) {
+    VvStatus status = VV_OK;
+
+    if (csv_error(csv) != NULL) status = set_error(ctx, VV_ERR_IO, csv_error(csv));
+    csv_close(csv);
+    return status;
+}
+
+// --- Library / Context Management ---
+
+int vv_abi_version(void) {
+    return VV_ABI_VERSION;
+}
+
+const char* vv_status_string(VvStatus status) {
+    switch (status) {
+        case VV_OK:                   return "OK";
+        case VV_ERR_INVALID_ARGUMENT: return "Invalid argument";
+        case VV_ERR_OUT_OF_MEMORY:    return "Out of memory";
+        case VV_ERR_IO:               return "I/O error";
+        case VV_ERR_FORMAT:           return "Malformed input";
+    }
+    return "Unknown status";
+}
+
+VvStatus vv_context_create(VvContext **out_ctx) {
+    if (out_ctx == NULL) return VV_ERR_INVALID_ARGUMENT;
+
+    VvContext *ctx = (VvContext*)malloc(sizeof(VvContext));
+    if (ctx == NULL) return VV_ERR_OUT_OF_MEMORY;
+
+    ctx->tolerance = 0.001;
+    ctx->last_error[0] = '\0';
+
+    *out_ctx = ctx;
+    return VV_OK;
+}
+
+void vv_context_destroy(VvContext *ctx) {
+    free(ctx);
+}
+
+VvStatus vv_context_set_tolerance(VvContext *ctx, double tolerance) {
+    if (ctx == NULL) return VV_ERR_INVALID_ARGUMENT;
+    if (!(tolerance >= 0.0)) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "Tolerance must be a non-negative number");
+    }
+    ctx->tolerance = tolerance;
+    return VV_OK;
+}
+
+const char* vv_context_last_error(const VvContext *ctx) {
+    return ctx != NULL ? ctx->last_error : "";
+}
+
+// --- Scalar Kernels ---
+
+double vv_scalar_product(const double a[3], const double b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+double vv_cross_product(const double a[3], const double b[3], double out[3]) {
+    double x = (a[1] * b[2]) - (b[1] * a[2]);
+    double y = (a[2] * b[0]) - (a[0] * b[2]);
+    double z = (a[0] * b[1]) - (b[0] * a[1]);
+
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+    return sqrt(x * x + y * y + z * z);
+}
+
+double vv_volume(const double a[3], const double b[3], const double c[3], double k) {
+    // Same operand order as volumeParallelepiped: (a x b) · c
+    double cross[3];
+    vv_cross_product(a, b, cross);
+    return fabs(vv_scalar_product(cross, c)) / k;
+}
+
+// --- Batch Kernels ---
+// The loops work directly on the caller's arrays: no vector structs are
+// built and no magnitudes are computed unless they were asked for.
+
+VvStatus vv_batch_scalar_product(VvContext *ctx, const double *a, const double *b,
+                                 size_t count, double *out) {
+    if (count == 0) return VV_OK;
+    if (a == NULL || b == NULL || out == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL array passed to batch scalar product");
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        out[i] = vv_scalar_product(&a[3 * i], &b[3 * i]);
+    }
+    return VV_OK;
+}
+
+VvStatus vv_batch_cross_product(VvContext *ctx, const double *a, const double *b,
+                                size_t count, double *out, double *magnitudes) {
+    if (count == 0) return VV_OK;
+    if (a == NULL || b == NULL || out == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL array passed to batch cross product");
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const double *p = &a[3 * i];
+        const double *q = &b[3 * i];
+        double *r = &out[3 * i];
+
+        r[0] = (p[1] * q[2]) - (q[1] * p[2]);
+        r[1] = (p[2] * q[0]) - (p[0] * q[2]);
+        r[2] = (p[0] * q[1]) - (q[0] * p[1]);
+    }
+
+    if (magnitudes != NULL) {
+        for (size_t i = 0; i < count; i++) {
+            const double *r = &out[3 * i];
+            magnitudes[i] = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+        }
+    }
+    return VV_OK;
+}
+
+VvStatus vv_batch_volume(VvContext *ctx, const double *a, const double *b,
+                         const double *c, size_t count, double k, double *out) {
+    if (count == 0) return VV_OK;
+    if (a == NULL || b == NULL || c == NULL || out == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL array passed to batch volume");
+    }
+    if (k == 0.0) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "Shape constant k must be non-zero");
+    }
+
+    double inv_k = 1.0 / k;
+    for (size_t i = 0; i < count; i++) {
+        const double *p = &a[3 * i];
+        const double *q = &b[3 * i];
+        const double *r = &c[3 * i];
+
+        double x = (p[1] * q[2]) - (q[1] * p[2]);
+        double y = (p[2] * q[0]) - (p[0] * q[2]);
+        double z = (p[0] * q[1]) - (q[0] * p[1]);
+
+        out[i] = fabs(x * r[0] + y * r[1] + z * r[2]) * inv_k;
+    }
+    return VV_OK;
+}
+
+VvStatus vv_batch_affine_transform(VvContext *ctx, const double matrix[9], const double translation[3],
+                                   const double *in, size_t count, double *out, double *determinant) {
+    if (matrix == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL matrix passed to batch transform");
+    }
+    if (determinant != NULL) *determinant = matrixDeterminant(matrix);
+    if (count == 0) return VV_OK;
+    if (in == NULL || out == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL array passed to batch transform");
+    }
+    if (out != in && out < in + 3 * count && in < out + 3 * count) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "Input and output arrays partially overlap");
+    }
+
+    const double m00 = matrix[0], m01 = matrix[1], m02 = matrix[2];
+    const double m10 = matrix[3], m11 = matrix[4], m12 = matrix[5];
+    const double m20 = matrix[6], m21 = matrix[7], m22 = matrix[8];
+    const double tx = translation ? translation[0] : 0.0;
+    const double ty = translation ? translation[1] : 0.0;
+    const double tz = translation ? translation[2] : 0.0;
+
+    // Each vector is read completely before it is written, which makes out == in safe
+#ifdef _OPENMP
+    #pragma omp parallel for simd schedule(static) if(count >= VV_PARALLEL_MIN)
+#endif
+    for (long long i = 0; i < (long long)count; i++) {
+        double x = in[3 * i], y = in[3 * i + 1], z = in[3 * i + 2];
+        out[3 * i]     = m00 * x + m01 * y + m02 * z + tx;
+        out[3 * i + 1] = m10 * x + m11 * y + m12 * z + ty;
+        out[3 * i + 2] = m20 * x + m21 * y + m22 * z + tz;
+    }
+    return VV_OK;
+}
+
+VvStatus vv_batch_point_in_parallelepiped(VvContext *ctx, const double *shapes,
+                                          const double *points, size_t count,
+                                          uint8_t *inside) {
+    if (count == 0) return VV_OK;
+    if (ctx == NULL || shapes == NULL || points == NULL || inside == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL argument passed to batch containment");
+    }
+
+    // Same Cramer's rule test as pointInParallelepiped, on raw arrays
+    double tolerance = ctx->tolerance;
+    for (size_t i = 0; i < count; i++) {
+        const double *a = &shapes[9 * i];
+        const double *b = a + 3;
+        const double *c = a + 6;
+        const double *p = &points[3 * i];
+        double bc[3], ca[3], ab[3];
+
+        vv_cross_product(b, c, bc);
+        double det = vv_scalar_product(a, bc);
+        if (fabs(det) < 1e-12) {
+            inside[i] = 0;
+            continue;
+        }
+        vv_cross_product(c, a, ca);
+        vv_cross_product(a, b, ab);
+
+        double alpha = vv_scalar_product(p, bc) / det;
+        double beta  = vv_scalar_product(p, ca) / det;
+        double gamma = vv_scalar_product(p, ab) / det;
+        double low = -tolerance, high = 1.0 + tolerance;
+
+        inside[i] = (alpha >= low && alpha <= high &&
+                     beta  >= low && beta  <= high &&
+                     gamma >= low && gamma <= high) ? 1 : 0;
+    }
+    return VV_OK;
+}
+
+// --- CSV Test Runners ---
+
+VvStatus vv_run_volume_tests(VvContext *ctx, const char *csv_path, double k,
+                             VvTestSummary *summary) {
+    CsvFile *csv = NULL;
+    TestCase current_test;
+
+    if (ctx == NULL || csv_path == NULL || summary == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL argument passed to volume test runner");
+    }
+    if (k == 0.0) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "Shape constant k must be non-zero");
+    }
+    memset(summary, 0, sizeof(*summary));
+
+    unsigned mask = CSV_MASK_VECTORS | CSV_MASK_EXPECTED;
+    VvStatus status = open_test_file(ctx, csv_path, mask, &csv);
+    if (status != VV_OK) return status;
+
+    while (csv_read_line(csv)) {
+        summary->total++;
+
+        if (!csv_read_test_case_columns(csv, &current_test, mask)) {
+            summary->errors++;
+            continue;
+        }
+
+        double calculated_volume;
+        if (current_test.integer_coordinates) {
+            calculated_volume = volumeParallelepipedExact(current_test.int_coordinates, k);
+            summary->exact_rows++;
+        } else {
+            vector vectors[3] = {current_test.v1, current_test.v2, current_test.v3};
+            calculated_volume = volumeParallelepiped(vectors, k);
+            summary->float_rows++;
+        }
+        double expected_volume = current_test.expected_volume / k;
+
+        if (fabs(calculated_volume - expected_volume) < ctx->tolerance) {
+            summary->passed++;
+        } else {
+            summary->failed++;
+        }
+    }
+
+    return close_test_file(ctx, csv);
+}
+
+VvStatus vv_run_scalar_product_tests(VvContext *ctx, const char *csv_path,
+                                     VvTestSummary *summary) {
+    CsvFile *csv = NULL;
+    TestCase current_test;
+
+    if (ctx == NULL || csv_path == NULL || summary == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL argument passed to scalar product test runner");
+    }
+    memset(summary, 0, sizeof(*summary));
+
+    unsigned mask = CSV_MASK_VECTORS;
+    VvStatus status = open_test_file(ctx, csv_path, mask, &csv);
+    if (status != VV_OK) return status;
+
+    while (csv_read_line(csv)) {
+        summary->total++;
+
+        if (!csv_read_test_case_columns(csv, &current_test, mask)) {
+            summary->errors++;
+            continue;
+        }
+
+        // Results are not reported individually; only parsing can fail here
+        (void)scalaricProduct(current_test.v1, current_test.v2);
+        (void)scalaricProduct(current_test.v1, current_test.v3);
+        (void)scalaricProduct(current_test.v2, current_test.v3);
+        summary->passed++;
+    }
+
+    return close_test_file(ctx, csv);
+}
+
+VvStatus vv_run_cross_product_tests(VvContext *ctx, const char *csv_path,
+                                    VvTestSummary *summary) {
+    CsvFile *csv = NULL;
+    TestCase current_test;
+
+    if (ctx == NULL || csv_path == NULL || summary == NULL) {
+        return set_error(ctx, VV_ERR_INVALID_ARGUMENT, "NULL argument passed to cross product test runner");
+    }
+    memset(summary, 0, sizeof(*summary));
+
+    unsigned mask = CSV_MASK_V1 | CSV_MASK_V2;
+    VvStatus status = open_test_file(ctx, csv_path, mask, &csv);
+    if (status != VV_OK) return status;
+
+    while (csv_read_line(csv)) {
+        summary->total++;
+
+        if (!csv_read_test_case_columns(csv, &current_test, mask)) {
+            summary->errors++;
+            continue;
+        }
+
+        vector result = crossProduct(current_test.v1, current_test.v2);
+        double dot_v1 = scalaricProduct(result, current_test.v1);
+        double dot_v2 = scalaricProduct(result, current_test.v2);
+
+        if (fabs(dot_v1) > ctx->tolerance || fabs(dot_v2) > ctx->tolerance) {
+            summary->failed++;
+        } else {
+            summary->passed++;
+        }
+    }
+
+    return close_test_file(ctx, csv);
+}
@@ -0,0 +1,198 @@
+#ifndef VECVOL_H
+#define VECVOL_H
+
+/*
+ * libvecvol - in-process C interface to the calculator.
+ *
+ * Every call works on caller-owned memory or on an opaque VvContext, the
+ * library keeps no global state and never writes to stdout/stderr.
+ * Vectors are passed as plain double[3] arrays (x, y, z); batch calls take
+ * interleaved arrays of 3 * count doubles.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32) && defined(VV_BUILD_LIBRARY)
+    #define VV_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(VV_SHARED)
+    #define VV_API __declspec(dllimport)
+#elif defined(__GNUC__)
+    #define VV_API __attribute__((visibility("default")))
+#else
+    #define VV_API
+#endif
+
+#define VV_ABI_VERSION 2
+
+// --- Status Codes ---
+typedef enum {
+    VV_OK = 0,
+    VV_ERR_INVALID_ARGUMENT = 1,
+    VV_ERR_OUT_OF_MEMORY = 2,
+    VV_ERR_IO = 3,
+    VV_ERR_FORMAT = 4
+} VvStatus;
+
+// --- Opaque Handle ---
+typedef struct VvContext VvContext;
+
+// --- Test Run Summary ---
+typedef struct {
+    uint64_t total;  // Data rows read (header excluded)
+    uint64_t passed; // Rows within tolerance
+    uint64_t failed; // Rows outside tolerance
+    uint64_t errors; // Rows that could not be parsed
+    uint64_t exact_rows; // Volume rows computed on the exact integer path
+    uint64_t float_rows; // Volume rows computed in floating point
+} VvTestSummary;
+
+// --- Library / Context Management ---
+
+/**
+ * @brief Returns the ABI version the library was built with (VV_ABI_VERSION)
+ */
+VV_API int vv_abi_version(void);
+
+/**
+ * @brief Returns a static, human readable description of a status code
+ * @param status Status code
+ * @return Description string (never NULL)
+ */
+VV_API const char* vv_status_string(VvStatus status);
+
+/**
+ * @brief Creates a new context with default settings (tolerance 0.001)
+ * @param out_ctx Receives the new context
+ * @return VV_OK, or an error status
+ */
+VV_API VvStatus vv_context_create(VvContext **out_ctx);
+
+/**
+ * @brief Destroys a context created by vv_context_create (NULL is allowed)
+ * @param ctx Context to destroy
+ */
+VV_API void vv_context_destroy(VvContext *ctx);
+
+/**
+ * @brief Sets the absolute tolerance used by the test runners
+ * @param ctx Context
+ * @param tolerance Non-negative tolerance
+ * @return VV_OK, or VV_ERR_INVALID_ARGUMENT
+ */
+VV_API VvStatus vv_context_set_tolerance(VvContext *ctx, double tolerance);
+
+/**
+ * @brief Returns a description of the last error reported on this context
+ * @param ctx Context
+ * @return Message string owned by the context (empty if no error)
+ */
+VV_API const char* vv_context_last_error(const VvContext *ctx);
+
+// --- Scalar Kernels ---
+
+/**
+ * @brief Scalar (dot) product of two vectors
+ */
+VV_API double vv_scalar_product(const double a[3], const double b[3]);
+
+/**
+ * @brief Cross product of two vectors
+ * @param out Receives a x b
+ * @return Magnitude of the cross product
+ */
+VV_API double vv_cross_product(const double a[3], const double b[3], double out[3]);
+
+/**
+ * @brief Volume |a · (b x c)| / k (k=1 parallelepiped, k=6 pyramid)
+ */
+VV_API double vv_volume(const double a[3], const double b[3], const double c[3], double k);
+
+// --- Batch Kernels ---
+
+/**
+ * @brief out[i] = a[i] · b[i] for count vector pairs
+ * @param ctx Context (receives error details)
+ * @param a Interleaved vectors (3 * count doubles)
+ * @param b Interleaved vectors (3 * count doubles)
+ * @param count Number of pairs
+ * @param out Receives count results
+ */
+VV_API VvStatus vv_batch_scalar_product(VvContext *ctx, const double *a, const double *b,
+                                        size_t count, double *out);
+
+/**
+ * @brief out[i] = a[i] x b[i] for count vector pairs
+ * @param out Receives 3 * count doubles
+ * @param magnitudes Receives count magnitudes, may be NULL
+ */
+VV_API VvStatus vv_batch_cross_product(VvContext *ctx, const double *a, const double *b,
+                                       size_t count, double *out, double *magnitudes);
+
+/**
+ * @brief out[i] = |a[i] · (b[i] x c[i])| / k for count vector triples
+ */
+VV_API VvStatus vv_batch_volume(VvContext *ctx, const double *a, const double *b,
+                                const double *c, size_t count, double k, double *out);
+
+/**
+ * @brief inside[i] = 1 if points[i] lies in the parallelepiped spanned by shapes[i]
+ * @param shapes Three edge vectors per item (9 * count doubles: V1, V2, V3)
+ * @param points Interleaved points (3 * count doubles)
+ * @param inside Receives count flags (0/1); the context tolerance widens the shape
+ */
+VV_API VvStatus vv_batch_point_in_parallelepiped(VvContext *ctx, const double *shapes,
+                                                 const double *points, size_t count,
+                                                 uint8_t *inside);
+
+/**
+ * @brief out[i] = M * in[i] + t for count vectors (parallel and vectorized with OpenMP)
+ * Works in place when out == in; partially overlapping arrays are rejected.
+ * Every volume spanned by transformed vectors is |det(M)| times the original
+ * volume, so transformed volumes need no new triple products. Translate
+ * points only: pass translation NULL when transforming edge vectors.
+ * @param matrix Row-major 3x3 matrix M (9 doubles)
+ * @param translation Offset t (3 doubles), or NULL for a linear map
+ * @param in Interleaved vectors (3 * count doubles)
+ * @param count Number of vectors
+ * @param out Receives 3 * count doubles (may be in)
+ * @param determinant Receives det(M), may be NULL
+ */
+VV_API VvStatus vv_batch_affine_transform(VvContext *ctx, const double matrix[9], const double translation[3],
+                                          const double *in, size_t count, double *out, double *determinant);
+
+// --- CSV Test Runners (silent counterparts of testerFile.c) ---
+
+/**
+ * @brief Validates computed volumes against EXPECTED_VOLUME / k for every row
+ * @param ctx Context (tolerance and error details)
+ * @param csv_path Path to a 13-column test case CSV with header
+ * @param k Shape constant (1 parallelepiped, 6 pyramid)
+ * @param summary Receives the counters (up to the failing row on VV_ERR_IO)
+ * @return VV_OK, or VV_ERR_IO when the file could not be read to the end
+ *         (e.g. a corrupt or truncated compressed file)
+ */
+VV_API VvStatus vv_run_volume_tests(VvContext *ctx, const char *csv_path, double k,
+                                    VvTestSummary *summary);
+
+/**
+ * @brief Computes V1·V2, V1·V3, V2·V3 for every row (passed = parsed rows)
+ */
+VV_API VvStatus vv_run_scalar_product_tests(VvContext *ctx, const char *csv_path,
+                                            VvTestSummary *summary);
+
+/**
+ * @brief Computes V1 x V2 for every row and checks it is perpendicular to V1 and V2
+ */
+VV_API VvStatus vv_run_cross_product_tests(VvContext *ctx, const char *csv_path,
+                                           VvTestSummary *summary);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VECVOL_H